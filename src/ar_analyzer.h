@@ -0,0 +1,332 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "wave_analyzer.h"   // WaveAnalyzerOptions, SpectralWaveStats, heaveDisplacementWeight
+
+//
+// Autoregressive (maximum-entropy) wave spectrum: Burg's method on one record of
+// heave acceleration, Hs/Tp from the model spectrum. Pure C++ (no Arduino
+// dependency); drop-in for WaveAnalyzer in wave.cpp (same reset/push/finish/analyze
+// sequence).
+//
+// ArWaveAnalyzer<MAX_N, FS, ORDER, Opt>: keeps up to MAX_N samples at FS Hz and fits
+// an AR(ORDER) model y[n] = Σ d[k]·y[n−k] + e[n] (Burg: reflection coefficients from
+// forward and backward prediction errors, so the model is always stable). Its
+// one-sided PSD is a closed form at any frequency:
+//   S(f) = 2·σ²/FS / |1 − Σ d[k]·e^(−j2πfk/FS)|²
+//
+// The model is fitted to y = displacement-like record, not to the acceleration: an
+// AR peak has Lorentzian (1/Δf²) skirts, and 1/ω⁴ weighting of an acceleration model
+// turns its low-frequency skirt into a spurious peak at FREQ_MIN that swamps Hs and
+// Tp. y is the record through two leaky integrators, 1/(1 − βz⁻¹)² with the pole at
+// PRE_FC_HZ, which is ≈1/ω² over the band; their start-up response (c0 + c1·n)·βⁿ and
+// a quadratic trend are projected out, so no samples are lost to settling.
+// analyze() evaluates S(f) on a GRID_DF grid and weights it by the displacement
+// weight times |1 − βe^(−jθ)|⁴: m0 = Σ S·w·df (rescaled by the model's exact total
+// power, see analyze()), Hs = 4√m0, Tp from the highest interior maximum of the
+// displacement spectrum, refined to GRID_DF/16 (the band edge only if there is none).
+//
+// A few poles give a sharp peak from a record too short for a stable Welch estimate,
+// at the price of Hs and Tp depending on the order chosen.
+//
+// Memory: forward and backward error arrays, 8·MAX_N bytes (the first holds the
+// record while sampling). Burg costs ~6·ORDER flops per sample, once, in finish().
+//
+
+template <uint32_t MAX_N, uint32_t FS, uint32_t ORDER, typename Opt = WaveAnalyzerOptions>
+class ArWaveAnalyzer {
+ public:
+  static_assert(ORDER >= 2 && MAX_N >= 8 * ORDER, "AR record must be at least 8x the model order");
+
+  static constexpr float FS_HZ = (float)FS;
+  static constexpr uint32_t MIN_SAMPLES = 8 * ORDER;   // Shortest record finish() will fit
+  static constexpr float GRID_DF = 0.002f;             // Model spectrum grid (Hz)
+  static constexpr double PRE_FC_HZ = 0.05;            // Pre-integrator pole
+  static constexpr double LOADING = 1e-6;              // White floor re record power (-60dB)
+  static constexpr uint32_t GRID_POINTS =
+      (uint32_t)((Opt::FREQ_MAX - Opt::FREQ_MIN) / GRID_DF + 0.5f) + 1;
+
+  void reset() {
+    count_ = 0;
+    fitted_ = false;
+    sigma2_ = 0.0f;
+    power_ = 0.0f;
+    m0_ = 0.0f;
+    gridScale_ = 1.0f;
+  }
+
+  // One settled heave acceleration sample (m/s²); samples beyond MAX_N are dropped
+  void push(float a) {
+    if (count_ < MAX_N) f_[count_++] = a;
+  }
+
+  uint32_t samples() const { return count_; }
+
+  // The record counts as one segment once it is long enough to fit
+  uint16_t segments() const { return count_ >= MIN_SAMPLES ? 1 : 0; }
+
+  // A single record has no segment spread to derive a CI from. hsOut (optional)
+  // receives Hs once analyze() has run. Always returns NAN.
+  float hsConfidence(float* hsOut) const {
+    if (hsOut) *hsOut = 4.0f * sqrtf(m0_);
+    return NAN;
+  }
+
+  // Fits the AR model (Burg). Call once, after the last push.
+  void finish() {
+    const uint32_t n = count_;
+    if (n < MIN_SAMPLES) return;
+
+    float mean = 0.0f;
+    for (uint32_t i = 0; i < n; i++) mean += f_[i];
+    mean /= (float)n;
+    preIntegrate(mean);
+    double e = 0.0;
+    for (uint32_t i = 0; i < n; i++) e += (double)f_[i] * f_[i];
+    e /= (double)n;
+    if (e <= 0.0) return;
+    power_ = (float)e;
+
+    // f_[j] = forward error at n = j+1, b_[j] = backward error at n = j (stage 0:
+    // both the samples themselves), shifted so each pair stays index-aligned
+    for (uint32_t j = 0; j + 1 < n; j++) b_[j] = f_[j];
+    for (uint32_t j = 0; j + 1 < n; j++) f_[j] = f_[j + 1];
+
+    float prev[ORDER];
+    for (uint32_t m = 0; m < ORDER; m++) {
+      // Reflection coefficient minimising forward + backward error power. The
+      // LOADING floor keeps |k| < 1 on noise-free input (a pure tone would
+      // otherwise put poles on the unit circle, beyond float precision).
+      const uint32_t len = n - m - 1;
+      double num = 0.0, den = 2.0 * (double)len * LOADING * (double)power_;
+      for (uint32_t j = 0; j < len; j++) {
+        num += (double)f_[j] * b_[j];
+        den += (double)f_[j] * f_[j] + (double)b_[j] * b_[j];
+      }
+      const float k = (den > 0.0) ? (float)(2.0 * num / den) : 0.0f;
+      e *= 1.0 - (double)k * k;
+
+      // Levinson update of the predictor
+      d_[m] = k;
+      for (uint32_t i = 0; i < m; i++) d_[i] = prev[i] - k * prev[m - 1 - i];
+      for (uint32_t i = 0; i <= m; i++) prev[i] = d_[i];
+
+      // Next-stage errors, shrinking the arrays by one
+      for (uint32_t j = 0; j + 1 < len; j++) {
+        const float fj = f_[j];
+        f_[j] = f_[j + 1] - k * b_[j + 1];
+        b_[j] = b_[j] - k * fj;
+      }
+    }
+    sigma2_ = (float)e;
+    fitted_ = true;
+  }
+
+  // Integrates the model spectrum into Hs/Tp (no sanity caps)
+  SpectralWaveStats analyze() {
+    SpectralWaveStats result = {0.0f, 0.0f, 0.0f, 0, false, {}};
+    result.nBins = (uint16_t)GRID_POINTS;
+    if (!fitted_) return result;
+
+    // d2, d1, d: displacement PSD at grid points i-2, i-1, i. The moments come
+    // from the same pass.
+    float m0 = 0.0f, d1 = 0.0f, d2 = 0.0f;
+    float mNeg1 = 0.0f, m1 = 0.0f, m2 = 0.0f, m4 = 0.0f, fS2 = 0.0f;
+    float edgePeak = 0.0f, peak = 0.0f;
+    uint32_t edgeIdx = 0, peakIdx = 0;
+    for (uint32_t i = 0; i < GRID_POINTS; i++) {
+      const float f = gridFreq(i);
+      const float d = displacementPsd(f);
+      const float f2 = f * f;
+      m0 += d;
+      mNeg1 += d / f;
+      m1 += d * f;
+      m2 += d * f2;
+      m4 += d * f2 * f2;
+      fS2 += d * d * f;
+      if (d > edgePeak) { edgePeak = d; edgeIdx = i; }
+      if (i >= 2 && d1 > d2 && d1 >= d && d1 > peak) { peak = d1; peakIdx = i - 1; }
+      d2 = d1;
+      d1 = d;
+    }
+    m0 *= GRID_DF;
+    if (peakIdx == 0) peakIdx = edgeIdx;
+    float peakFreq = refinePeak(gridFreq(peakIdx));
+
+    // A peak narrower than the grid (near-pure swell, poles at |z| → 1) is missed
+    // or overshot by the sum, depending on where the grid points fall. The model's
+    // power over 0..FS/2 is exactly the variance of y, so the same grid over the
+    // whole range gives the sum's error factor; it is ~1 for smooth spectra.
+    const float gridPower = modelPowerOnGrid();
+    gridScale_ = (gridPower > 0.0f) ? power_ / gridPower : 1.0f;
+    m0 *= gridScale_;
+    m0_ = m0;
+    const float g = GRID_DF * gridScale_;
+    result.moments = {mNeg1 * g, m0, m1 * g, m2 * g, m4 * g, fS2 * g * gridScale_};
+    if (m0 <= 0.0f) return result;
+
+    result.Hs = 4.0f * sqrtf(m0);
+    result.Tp = (peakFreq > 0.0f) ? 1.0f / peakFreq : 0.0f;
+    result.P = 0.49f * result.Hs * result.Hs * result.Tp; // deep-water power proxy
+    return result;
+  }
+
+  // Mean displacement PSD over [fLo, fHi] Hz (m²/Hz), after analyze(): the analysis
+  // grid points in [fLo, fHi) with the same power rescaling as m0, so resampling
+  // onto a coarser grid keeps m0 (the model at the midpoint if no point falls inside)
+  float displacementPsdMean(float fLo, float fHi) const {
+    if (!fitted_ || fHi <= fLo) return 0.0f;
+    const float x = (fLo - Opt::FREQ_MIN) / GRID_DF;
+    float sum = 0.0f;
+    uint32_t n = 0;
+    for (uint32_t i = (x > 0.0f) ? (uint32_t)ceilf(x - 1e-3f) : 0;
+         i < GRID_POINTS && gridFreq(i) < fHi - 1e-3f * GRID_DF; i++) {
+      sum += displacementPsd(gridFreq(i));
+      n++;
+    }
+    if (n == 0) return displacementPsd(0.5f * (fLo + fHi)) * gridScale_;
+    return sum * GRID_DF / (fHi - fLo) * gridScale_;
+  }
+
+  // One-sided PSD of the fitted model of y at f Hz
+  float modelPsd(float f) const {
+    const float theta = 2.0f * (float)FFT_PI * f / FS_HZ;
+    const float c = cosf(theta), s = sinf(theta);
+    float pr = 1.0f, pi = 0.0f, ar = 1.0f, ai = 0.0f;
+    for (uint32_t k = 0; k < ORDER; k++) {
+      const float t = pr * c - pi * s;   // e^(jθ(k+1)); |A| is the same for either sign
+      pi = pi * c + pr * s;
+      pr = t;
+      ar -= d_[k] * pr;
+      ai -= d_[k] * pi;
+    }
+    return 2.0f * sigma2_ / FS_HZ / (ar * ar + ai * ai);
+  }
+
+  // AR coefficients d[0..ORDER-1] (x[n] = Σ d[k]·x[n−1−k] + e) and innovation variance
+  const float* coefficients() const { return d_; }
+  float noiseVariance() const { return sigma2_; }
+
+ private:
+  static float gridFreq(uint32_t i) { return Opt::FREQ_MIN + (float)i * GRID_DF; }
+
+  float displacementPsd(float f) const { return modelPsd(f) * (float)displacementGain(f); }
+
+  // Local maximum of the displacement PSD within ±1 grid step of f: REFINE-point
+  // search, then a parabola through the best point and its neighbours
+  float refinePeak(float f) const {
+    static constexpr uint32_t REFINE = 32;
+    const float step = 2.0f * GRID_DF / (float)REFINE;
+    const float f0 = std::max(f - GRID_DF, Opt::FREQ_MIN);
+    float best = -1.0f, before = 0.0f, after = 0.0f, prev = 0.0f;
+    uint32_t bestJ = 0;
+    for (uint32_t j = 0; j <= REFINE; j++) {
+      const float d = displacementPsd(f0 + (float)j * step);
+      if (d > best) { best = d; bestJ = j; before = prev; after = 0.0f; }
+      else if (j == bestJ + 1) after = d;
+      prev = d;
+    }
+    float fp = f0 + (float)bestJ * step;
+    if (bestJ > 0 && bestJ < REFINE) {
+      const float denom = before - 2.0f * best + after;
+      if (fabsf(denom) > 1e-30f) fp += 0.5f * (before - after) / denom * step;
+    }
+    return fp;
+  }
+
+  // Rectangle-rule model power over 0..FS/2 on the band's grid (same offset, so a
+  // spike in the band is sampled identically by both sums)
+  float modelPowerOnGrid() const {
+    double sum = 0.0;
+    const float first = Opt::FREQ_MIN - GRID_DF * floorf(Opt::FREQ_MIN / GRID_DF);
+    const uint32_t points = (uint32_t)((FS_HZ / 2.0f - first) / GRID_DF);
+    for (uint32_t i = 0; i < points; i++) sum += modelPsd(first + (float)i * GRID_DF);
+    return (float)(sum * GRID_DF);
+  }
+
+  static constexpr double BETA = 1.0 - 2.0 * FFT_PI * PRE_FC_HZ / (double)FS;
+  static constexpr double PRE_GAIN = 1.0 / ((double)FS * (double)FS);   // dt², so y ≈ displacement (m)
+
+  // Displacement PSD / model PSD at f: 1/ω⁴ (with tracker correction) over |H_pre|²
+  static double displacementGain(float f) {
+    const double c = cos(2.0 * FFT_PI * (double)f / (double)FS);
+    const double inv = (1.0 - 2.0 * BETA * c + BETA * BETA) / PRE_GAIN;
+    return heaveDisplacementWeight<Opt>((double)f, (double)FS) * inv * inv;
+  }
+
+  // f_ (acceleration, mean subtracted here) → y in place: two leaky integrators,
+  // then projectOut(). Double precision: the integrators are ~1/(1 − β) samples deep
+  // (32 at 10Hz).
+  void preIntegrate(float mean) {
+    const uint32_t n = count_;
+    double y1 = 0.0, y2 = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+      y1 = (double)(f_[i] - mean) + BETA * y1;
+      y2 = y1 + BETA * y2;
+      f_[i] = (float)(y2 * PRE_GAIN);
+    }
+    projectOut();
+  }
+
+  // Least-squares removal from f_ of the integrators' zero-input response βⁱ, i·βⁱ
+  // and a quadratic trend (what is left of the band-pass and gravity tracker
+  // settling after a short settle; Welch hides it under the Hann taper)
+  static constexpr uint32_t DETREND = 5;
+  static void basis(uint32_t i, uint32_t n, double p, double* u) {
+    const double t = 2.0 * (double)i / (double)n - 1.0;
+    u[0] = p;
+    u[1] = (double)i * p;
+    u[2] = 1.0;
+    u[3] = t;
+    u[4] = t * t;
+  }
+
+  void projectOut() {
+    const uint32_t n = count_;
+    const uint32_t K = DETREND;
+    double G[DETREND][DETREND + 1] = {};   // Normal equations | right-hand side
+    double u[DETREND];
+    double p = 1.0;
+    for (uint32_t i = 0; i < n; i++) {
+      basis(i, n, p, u);
+      for (uint32_t a = 0; a < K; a++) {
+        for (uint32_t b = 0; b < K; b++) G[a][b] += u[a] * u[b];
+        G[a][K] += u[a] * (double)f_[i];
+      }
+      p *= BETA;
+    }
+    // Gauss-Jordan with partial pivoting; leaves G diagonal
+    for (uint32_t c = 0; c < K; c++) {
+      uint32_t piv = c;
+      for (uint32_t r = c + 1; r < K; r++) if (fabs(G[r][c]) > fabs(G[piv][c])) piv = r;
+      for (uint32_t j = 0; j <= K; j++) std::swap(G[c][j], G[piv][j]);
+      if (fabs(G[c][c]) < 1e-300) return;
+      for (uint32_t r = 0; r < K; r++) {
+        if (r == c) continue;
+        const double m = G[r][c] / G[c][c];
+        for (uint32_t j = c; j <= K; j++) G[r][j] -= m * G[c][j];
+      }
+    }
+    p = 1.0;
+    for (uint32_t i = 0; i < n; i++) {
+      basis(i, n, p, u);
+      double fit = 0.0;
+      for (uint32_t a = 0; a < K; a++) fit += G[a][K] / G[a][a] * u[a];
+      f_[i] -= (float)fit;
+      p *= BETA;
+    }
+  }
+
+  float f_[MAX_N];      // Record while sampling, then forward prediction errors
+  float b_[MAX_N];      // Backward prediction errors
+  float d_[ORDER] = {};
+  float sigma2_ = 0.0f;
+  float power_ = 0.0f;  // Variance of y = model power over 0..FS/2
+  float m0_ = 0.0f;
+  float gridScale_ = 1.0f;  // Model power / grid sum, from analyze()
+  uint32_t count_ = 0;
+  bool fitted_ = false;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdint.h>
+#include "fft.h"   // constexprSin / constexprCos
+
+//
+// Butterworth IIR filters as cascaded second-order sections (SOS), designed at
+// compile time. Pure C++ (no Arduino dependency).
+//
+// Design: analog Butterworth prototype of order 2·NS, bilinear transform with the
+// cutoff prewarped (K = tan(π·fc/fs)), so |H(fc)| = 1/√2 exactly. Section k uses the
+// pole pair at Q_k = 1/(2·sin(π(2k+1)/(4·NS))). Coefficients are evaluated by the
+// compiler in double precision and stored as float in flash (.rodata).
+//
+// Runtime: transposed direct form II, 5 multiplies per section, fixed trip count
+// and no branches in the inner loop. Two state floats per section.
+//
+
+struct Biquad {
+  float b0, b1, b2;   // numerator
+  float a1, a2;       // denominator (a0 normalised to 1)
+};
+
+template <uint32_t NS>
+struct Sos {
+  Biquad s[NS];
+};
+
+// ---- constexpr design ----
+
+namespace biquad_detail {
+
+constexpr double tanPrewarp(double fc, double fs) {
+  const double x = FFT_PI * fc / fs;
+  return constexprSin(x) / constexprCos(x);
+}
+
+// 1/Q of section k in a cascade of NS sections (Butterworth pole angles)
+constexpr double invQ(uint32_t k, uint32_t ns) {
+  return 2.0 * constexprSin(FFT_PI * (double)(2 * k + 1) / (double)(4 * ns));
+}
+
+}  // namespace biquad_detail
+
+// Low-pass, order 2·NS, unity gain at DC
+template <uint32_t NS>
+constexpr Sos<NS> butterworthLowpass(double fc, double fs) {
+  Sos<NS> f{};
+  const double K = biquad_detail::tanPrewarp(fc, fs);
+  for (uint32_t k = 0; k < NS; k++) {
+    const double iq = biquad_detail::invQ(k, NS);
+    const double norm = 1.0 / (1.0 + K * iq + K * K);
+    const double b0 = K * K * norm;
+    f.s[k] = {(float)b0, (float)(2.0 * b0), (float)b0,
+              (float)(2.0 * (K * K - 1.0) * norm), (float)((1.0 - K * iq + K * K) * norm)};
+  }
+  return f;
+}
+
+// High-pass, order 2·NS, unity gain at Nyquist
+template <uint32_t NS>
+constexpr Sos<NS> butterworthHighpass(double fc, double fs) {
+  Sos<NS> f{};
+  const double K = biquad_detail::tanPrewarp(fc, fs);
+  for (uint32_t k = 0; k < NS; k++) {
+    const double iq = biquad_detail::invQ(k, NS);
+    const double norm = 1.0 / (1.0 + K * iq + K * K);
+    f.s[k] = {(float)norm, (float)(-2.0 * norm), (float)norm,
+              (float)(2.0 * (K * K - 1.0) * norm), (float)((1.0 - K * iq + K * K) * norm)};
+  }
+  return f;
+}
+
+// Series connection: a then b
+template <uint32_t NA, uint32_t NB>
+constexpr Sos<NA + NB> sosCascade(const Sos<NA>& a, const Sos<NB>& b) {
+  Sos<NA + NB> f{};
+  for (uint32_t k = 0; k < NA; k++) f.s[k] = a.s[k];
+  for (uint32_t k = 0; k < NB; k++) f.s[NA + k] = b.s[k];
+  return f;
+}
+
+// |H(f)|² of the cascade as stored (float coefficients), evaluated in double.
+// constexpr so designs can be checked with static_assert.
+template <uint32_t NS>
+constexpr double sosGainSq(const Sos<NS>& f, double freq, double fs) {
+  const double th = 2.0 * FFT_PI * freq / fs;
+  const double c1 = constexprCos(th), s1 = constexprSin(th);
+  const double c2 = constexprCos(2.0 * th), s2 = constexprSin(2.0 * th);
+  double g = 1.0;
+  for (uint32_t k = 0; k < NS; k++) {
+    const Biquad& q = f.s[k];
+    const double nr = q.b0 + q.b1 * c1 + q.b2 * c2, ni = q.b1 * s1 + q.b2 * s2;
+    const double dr = 1.0 + q.a1 * c1 + q.a2 * c2, di = q.a1 * s1 + q.a2 * s2;
+    g *= (nr * nr + ni * ni) / (dr * dr + di * di);
+  }
+  return g;
+}
+
+// ---- runtime filter ----
+
+template <uint32_t NS>
+class SosFilter {
+ public:
+  explicit constexpr SosFilter(const Sos<NS>& coeffs) : c_(coeffs) {}
+
+  float process(float x) {
+    for (uint32_t k = 0; k < NS; k++) {
+      const Biquad& q = c_.s[k];
+      const float y = q.b0 * x + z1_[k];
+      z1_[k] = q.b1 * x - q.a1 * y + z2_[k];
+      z2_[k] = q.b2 * x - q.a2 * y;
+      x = y;
+    }
+    return x;
+  }
+
+  void reset() {
+    for (uint32_t k = 0; k < NS; k++) z1_[k] = z2_[k] = 0.0f;
+  }
+
+ private:
+  const Sos<NS>& c_;
+  float z1_[NS] = {};
+  float z2_[NS] = {};
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include "fft.h"   // constexprSin / constexprCos
+
+//
+// Polyphase FIR decimator: R input frames of CH channels in, one frame out.
+// Pure C++ (no Arduino dependency).
+//
+// Linear-phase low-pass of R·P taps (Blackman-windowed sinc, cutoff at the output
+// Nyquist fs_in/(2R), unity DC gain), designed at compile time and stored as float
+// in flash. Only the kept output phase is computed: R·P multiply-adds per channel
+// when an output is due and none on the other R-1 calls (P per input on average).
+// Passband flat (<0.15dB) to 0.3·fs_out, -6dB at fs_out/2, ≥78dB down from
+// fs_out/2 + 3·fs_out/P (0.8·fs_out for P = 10). Group delay (R·P-1)/2 input frames.
+//
+// History is kept as T (e.g. int16 sensor counts), twice over so the newest R·P
+// inputs are always contiguous: CH·2·R·P·sizeof(T) bytes.
+//
+
+template <uint32_t L>
+struct DecimatorTaps {
+  float h[L];
+};
+
+template <uint32_t L>
+constexpr DecimatorTaps<L> makeDecimatorTaps(uint32_t r) {
+  DecimatorTaps<L> t{};
+  double h[L] = {};
+  double sum = 0.0;
+  const double fc = 0.5 / (double)r;          // cycles per input sample
+  const double mid = (double)(L - 1) / 2.0;
+  for (uint32_t n = 0; n < L; n++) {
+    const double x = (double)n - mid;
+    const double sinc = (x == 0.0) ? 2.0 * fc
+                                   : constexprSin(2.0 * FFT_PI * fc * x) / (FFT_PI * x);
+    const double a = 2.0 * FFT_PI * (double)n / (double)(L - 1);
+    const double w = 0.42 - 0.5 * constexprCos(a) + 0.08 * constexprCos(2.0 * a);
+    h[n] = sinc * w;
+    sum += h[n];
+  }
+  for (uint32_t n = 0; n < L; n++) t.h[n] = (float)(h[n] / sum);
+  return t;
+}
+
+template <uint32_t R, uint32_t P, uint32_t CH, typename T = float>
+class FirDecimator {
+ public:
+  static_assert(R >= 2 && P >= 2, "FirDecimator needs a ratio and taps per phase of at least 2");
+
+  static constexpr uint32_t TAPS = R * P;
+  static constexpr DecimatorTaps<TAPS> taps = makeDecimatorTaps<TAPS>(R);
+
+  // Feeds one input frame (CH values). Every R-th call writes CH outputs and
+  // returns true. The first frame after reset() pre-fills the history, so a
+  // constant input gives a constant output from the first output on.
+  bool push(const T* in, float* out) {
+    if (!primed_) {
+      for (uint32_t c = 0; c < CH; c++)
+        for (uint32_t i = 0; i < 2 * TAPS; i++) hist_[c][i] = in[c];
+      primed_ = true;
+    }
+    for (uint32_t c = 0; c < CH; c++) hist_[c][pos_] = hist_[c][pos_ + TAPS] = in[c];
+    pos_ = (pos_ + 1 == TAPS) ? 0 : pos_ + 1;
+    if (++phase_ < R) return false;
+    phase_ = 0;
+
+    // hist_[c][pos_ .. pos_+TAPS-1] holds the last TAPS inputs, oldest first
+    for (uint32_t c = 0; c < CH; c++) {
+      const T* x = &hist_[c][pos_];
+      float acc = 0.0f;
+      for (uint32_t k = 0; k < TAPS; k++) acc += taps.h[k] * (float)x[k];
+      out[c] = acc;
+    }
+    return true;
+  }
+
+  void reset() {
+    pos_ = 0;
+    phase_ = 0;
+    primed_ = false;
+  }
+
+ private:
+  T hist_[CH][2 * TAPS] = {};
+  uint32_t pos_ = 0;
+  uint32_t phase_ = 0;
+  bool primed_ = false;
+};
@@ -0,0 +1,55 @@
+// DSP backend for the wave spectral kernels — see dsp.h
+
+#include "dsp.h"
+
+#if WAVE_DSP_ESPDSP
+#include <esp_dsp.h>
+
+// esp-dsp keeps one radix-2 twiddle table for all sizes up to the one it was
+// initialised with; (re)initialise lazily to the largest size requested.
+static uint32_t s_fftTablePoints = 0;
+
+bool dspEspComplexFft(float* z, uint32_t points) {
+  if (points > s_fftTablePoints) {
+    if (s_fftTablePoints > 0) dsps_fft2r_deinit_fc32();
+    if (dsps_fft2r_init_fc32(NULL, (int)points) != ESP_OK) {
+      s_fftTablePoints = 0;
+      return false;
+    }
+    s_fftTablePoints = points;
+  }
+  if (dsps_fft2r_fc32(z, (int)points) != ESP_OK) return false;
+  dsps_bit_rev_fc32(z, (int)points);
+  return true;
+}
+
+const char* dspBackendName() { return "esp-dsp"; }
+
+void dspAddConst(float* x, uint32_t n, float c) {
+  dsps_addc_f32(x, x, (int)n, c, 1, 1);
+}
+
+void dspMul(const float* a, const float* b, float* out, uint32_t n) {
+  dsps_mul_f32(a, b, out, (int)n, 1, 1, 1);
+}
+
+#else
+
+const char* dspBackendName() { return "portable"; }
+
+void dspAddConst(float* x, uint32_t n, float c) {
+  for (uint32_t i = 0; i < n; i++) x[i] += c;
+}
+
+void dspMul(const float* a, const float* b, float* out, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+}
+
+#endif
+
+float dspMean(const float* x, uint32_t n) {
+  if (n == 0) return 0.0f;
+  double sum = 0.0;
+  for (uint32_t i = 0; i < n; i++) sum += x[i];
+  return (float)(sum / (double)n);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include "fft.h"
+
+//
+// DSP backend for the wave spectral kernels (mean removal, windowing, real FFT).
+//
+// Two implementations behind one interface:
+//   - esp-dsp (Espressif's Xtensa-optimised library, shipped with arduino-esp32):
+//     dsps_addc_f32, dsps_mul_f32, dsps_fft2r_fc32 + dsps_bit_rev_fc32
+//   - portable C++: plain loops and RealFft<N> from fft.h (host builds, or a core
+//     without esp-dsp)
+//
+// The real FFT always uses the same packing and split step (RealFft<N>::split), so
+// only the N/2-point complex FFT differs between backends.
+//
+// WAVE_DSP_ESPDSP selects the backend: 1 = esp-dsp, 0 = portable.
+// Default: esp-dsp when building for ESP-IDF/Arduino-ESP32 and esp_dsp.h is found.
+//
+
+#ifndef WAVE_DSP_ESPDSP
+#if defined(ESP_PLATFORM) && defined(__has_include)
+#if __has_include(<esp_dsp.h>)
+#define WAVE_DSP_ESPDSP 1
+#endif
+#endif
+#endif
+#ifndef WAVE_DSP_ESPDSP
+#define WAVE_DSP_ESPDSP 0
+#endif
+
+// Short backend name for logs ("esp-dsp" or "portable")
+const char* dspBackendName();
+
+// x[i] += c
+void dspAddConst(float* x, uint32_t n, float c);
+
+// out[i] = a[i] * b[i] (out may alias a)
+void dspMul(const float* a, const float* b, float* out, uint32_t n);
+
+// Mean of x[0..n-1], accumulated in double (not vectorised on either backend)
+float dspMean(const float* x, uint32_t n);
+
+#if WAVE_DSP_ESPDSP
+// In-place N/2-point complex FFT (natural order in and out) via esp-dsp.
+// Returns false if the esp-dsp twiddle table could not be initialised.
+bool dspEspComplexFft(float* z, uint32_t points);
+#endif
+
+// In-place real FFT with the RealFft<N>::forward() output packing.
+// Falls back to the portable complex FFT if esp-dsp init fails.
+template <uint32_t N>
+inline void dspRealFft(float* buf) {
+#if WAVE_DSP_ESPDSP
+  if (dspEspComplexFft(buf, N / 2)) {
+    RealFft<N>::split(buf);
+    return;
+  }
+#endif
+  RealFft<N>::forward(buf);
+}
+
+// In-place inverse of dspRealFft(): packed real spectrum → N real samples (with 1/N)
+template <uint32_t N>
+inline void dspRealIfft(float* buf) {
+#if WAVE_DSP_ESPDSP
+  RealFft<N>::merge(buf);
+  RealFft<N>::conjugate(buf);
+  if (dspEspComplexFft(buf, N / 2)) {
+    RealFft<N>::conjugate(buf, 1.0f / (float)(N / 2));
+    return;
+  }
+  RealFft<N>::complexFft(buf);
+  RealFft<N>::conjugate(buf, 1.0f / (float)(N / 2));
+#else
+  RealFft<N>::inverse(buf);
+#endif
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stdint.h>
+
+//
+// Real-input FFT with compile-time twiddle and window tables.
+// Pure C++ (no Arduino dependency) so the same kernel runs on the ESP32 and on a host.
+//
+// N real samples are packed into N/2 complex values (even samples → real, odd → imag),
+// transformed with an in-place radix-2 FFT of length N/2, then split into the N/2+1
+// non-negative frequency bins of the real spectrum. No separate imaginary buffer.
+//
+// Twiddles and the Hann window are evaluated by the compiler in double precision and
+// stored as float tables in flash (.rodata), so host and target start from the same
+// tables. Results agree to float rounding, not bit for bit: GCC may fuse a*b+c into
+// madd.s on Xtensa. tools/wave_bench checks the error against a double DFT (<1e-6
+// of the largest bin, with or without fused multiply-add).
+//
+// Memory (flash): N/2 cos + N/2 sin + N Hann floats = 8·N bytes (4KB for N=512).
+//
+
+// ---- constexpr trigonometry (compile-time only) ----
+
+constexpr double FFT_PI = 3.14159265358979323846264338327950288;
+
+// Taylor series after reduction to [-pi, pi]; 30 terms is far below double epsilon there.
+constexpr double constexprSin(double x) {
+  while (x > FFT_PI) x -= 2.0 * FFT_PI;
+  while (x < -FFT_PI) x += 2.0 * FFT_PI;
+  double term = x, sum = x;
+  for (int n = 1; n < 30; n++) {
+    term *= -x * x / (double)((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double constexprCos(double x) { return constexprSin(x + FFT_PI / 2.0); }
+
+template <uint32_t N>
+struct FftTables {
+  float cosTw[N / 2];   // cos(2πk/N), k = 0..N/2-1
+  float sinTw[N / 2];   // sin(2πk/N), k = 0..N/2-1
+  float hann[N];        // Periodic Hann: 0.5·(1 − cos(2πi/N)), mean(w²) = 3/8
+};
+
+template <uint32_t N>
+constexpr FftTables<N> makeFftTables() {
+  FftTables<N> t{};
+  for (uint32_t k = 0; k < N / 2; k++) {
+    t.cosTw[k] = (float)constexprCos(2.0 * FFT_PI * (double)k / (double)N);
+    t.sinTw[k] = (float)constexprSin(2.0 * FFT_PI * (double)k / (double)N);
+  }
+  for (uint32_t i = 0; i < N; i++) {
+    t.hann[i] = (float)(0.5 * (1.0 - constexprCos(2.0 * FFT_PI * (double)i / (double)N)));
+  }
+  return t;
+}
+
+// ---- Real FFT ----
+//
+// forward(buf): buf holds N real samples on entry. On return:
+//   buf[0]         = Re X[0]    (DC, purely real)
+//   buf[1]         = Re X[N/2]  (Nyquist, purely real)
+//   buf[2k], [2k+1] = Re, Im X[k] for k = 1..N/2-1
+//
+// inverse(buf) takes that packing back to N real samples (including the 1/N), so
+// inverse(forward(x)) = x to float rounding.
+//
+template <uint32_t N>
+class RealFft {
+ public:
+  static_assert(N >= 4 && (N & (N - 1)) == 0, "RealFft length must be a power of 2 (>= 4)");
+
+  static constexpr uint32_t BINS = N / 2 + 1;
+  static constexpr FftTables<N> tables = makeFftTables<N>();
+
+  static void forward(float* buf) {
+    complexFft(buf);
+    split(buf);
+  }
+
+  // Second half of forward(): turns the N/2-point complex FFT of the packed input
+  // (natural order) into the packed real spectrum. Public so an accelerated
+  // complex FFT (see dsp.h) can be combined with it.
+  static void split(float* buf) {
+    const uint32_t M = N / 2;
+    // Split the N/2-point complex spectrum Z into the real spectrum X:
+    //   Fe = (Z[k] + conj Z[M-k]) / 2,  Fo = (Z[k] − conj Z[M-k]) / 2i
+    //   X[k] = Fe + W^k·Fo,  X[M-k] = conj(Fe − W^k·Fo),  W = e^(−2πi/N)
+    float z0r = buf[0], z0i = buf[1];
+    buf[0] = z0r + z0i;
+    buf[1] = z0r - z0i;
+    for (uint32_t k = 1; k <= M / 2; k++) {
+      float ar = buf[2 * k],       ai = buf[2 * k + 1];
+      float br = buf[2 * (M - k)], bi = buf[2 * (M - k) + 1];
+      float fer = 0.5f * (ar + br), fei = 0.5f * (ai - bi);
+      float for_ = 0.5f * (ai + bi), foi = -0.5f * (ar - br);
+      float wr = tables.cosTw[k], wi = -tables.sinTw[k];
+      float tr = wr * for_ - wi * foi;
+      float ti = wr * foi + wi * for_;
+      buf[2 * k]           = fer + tr;
+      buf[2 * k + 1]       = fei + ti;
+      buf[2 * (M - k)]     = fer - tr;
+      buf[2 * (M - k) + 1] = -(fei - ti);
+    }
+  }
+
+  static void inverse(float* buf) {
+    merge(buf);
+    conjugate(buf);
+    complexFft(buf);
+    conjugate(buf, 1.0f / (float)(N / 2));
+  }
+
+  // First half of inverse(): the inverse of split(), packed real spectrum → the
+  // N/2-point complex spectrum Z of the packed samples (even → real, odd → imag):
+  //   Fe = (X[k] + conj X[M-k]) / 2,  Fo = (X[k] − conj X[M-k]) / (2W^k),  Z = Fe + i·Fo
+  // Z then needs an inverse complex FFT (see conjugate()).
+  static void merge(float* buf) {
+    const uint32_t M = N / 2;
+    const float x0 = buf[0], xm = buf[1];
+    buf[0] = 0.5f * (x0 + xm);
+    buf[1] = 0.5f * (x0 - xm);
+    for (uint32_t k = 1; k <= M / 2; k++) {
+      float ar = buf[2 * k],       ai = buf[2 * k + 1];
+      float br = buf[2 * (M - k)], bi = buf[2 * (M - k) + 1];
+      float fer = 0.5f * (ar + br), fei = 0.5f * (ai - bi);
+      float dr = 0.5f * (ar - br), di = 0.5f * (ai + bi);
+      float wr = tables.cosTw[k], wi = tables.sinTw[k];      // conj W^k = 1/W^k
+      float for_ = dr * wr - di * wi;
+      float foi = dr * wi + di * wr;
+      // Z[k] = Fe + i·Fo; Z[M-k] = conj Fe + i·conj Fo
+      buf[2 * k]           = fer - foi;
+      buf[2 * k + 1]       = fei + for_;
+      buf[2 * (M - k)]     = fer + foi;
+      buf[2 * (M - k) + 1] = -fei + for_;
+    }
+  }
+
+  // z ← conj(z)·scale for N/2 interleaved complex values. An inverse FFT is
+  // conjugate(), forward complex FFT, conjugate(1/(N/2)).
+  static void conjugate(float* z, float scale = 1.0f) {
+    for (uint32_t i = 0; i < N / 2; i++) {
+      z[2 * i] *= scale;
+      z[2 * i + 1] *= -scale;
+    }
+  }
+
+  // |X[k]|² for k = 0..N/2 from the packed forward() output
+  static inline float binPower(const float* buf, uint32_t k) {
+    if (k == 0) return buf[0] * buf[0];
+    if (k == N / 2) return buf[1] * buf[1];
+    return buf[2 * k] * buf[2 * k] + buf[2 * k + 1] * buf[2 * k + 1];
+  }
+
+  // In-place radix-2 DIT FFT of N/2 interleaved complex values.
+  // Twiddle for stage length L, index j: W_L^j = W_N^(j·N/L).
+  static void complexFft(float* z) {
+    const uint32_t M = N / 2;
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < M - 1; i++) {
+      if (i < j) {
+        float tr = z[2 * i], ti = z[2 * i + 1];
+        z[2 * i] = z[2 * j]; z[2 * i + 1] = z[2 * j + 1];
+        z[2 * j] = tr;       z[2 * j + 1] = ti;
+      }
+      uint32_t k = M >> 1;
+      while (k <= j) { j -= k; k >>= 1; }
+      j += k;
+    }
+    for (uint32_t len = 2; len <= M; len <<= 1) {
+      const uint32_t half = len / 2;
+      const uint32_t step = N / len;
+      for (uint32_t i = 0; i < M; i += len) {
+        for (uint32_t k = 0; k < half; k++) {
+          float wr = tables.cosTw[k * step], wi = -tables.sinTw[k * step];
+          uint32_t u = 2 * (i + k), v = 2 * (i + k + half);
+          float tr = wr * z[v] - wi * z[v + 1];
+          float ti = wr * z[v + 1] + wi * z[v];
+          z[v]     = z[u] - tr;
+          z[v + 1] = z[u + 1] - ti;
+          z[u]     += tr;
+          z[u + 1] += ti;
+        }
+      }
+    }
+  }
+};
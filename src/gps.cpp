@@ -5,10 +5,14 @@
 #include "modem.h"
 #include "rtc_state.h"
 #include "utils.h"
+#include "wave.h"
 
 #include <Preferences.h>
 #include <time.h>
 #include <sys/time.h>
+#include <string.h>
+#include "esp_sleep.h"
+#include "driver/uart.h"
 
 #define SerialMon Serial
 
@@ -30,9 +34,107 @@ static const uint32_t XTRA_STALE_DAYS     = 3;  // Datasheet: xtra3grc.bin valid
 // Fallback: accept any fix after 80% of timeout has elapsed.
 static const float HDOP_ACCEPT_THRESHOLD = 3.0f;
 
+// Acquisition: 60s warmup (any valid fix accepted), then up to timeoutSec more with
+// the HDOP gate, relaxed for the last 20%.
+static const uint32_t GNSS_WARMUP_MS    = 60000;
+static const uint32_t GNSS_REPORT_MS    = 1000;   // CGNSRTMS=1000: one navigation report per second
+static const uint32_t GNSS_STATUS_MS    = 30000;  // Progress log cadence
+
+// Default GPS_NAV_URC to 1: the modem pushes a +UGNSINF: report per fix (AT+CGNSURC=1)
+// and the acquisition loop reacts to each one as it arrives. 0 = poll AT+CGNSINF
+// once a second (also the fallback if the modem rejects CGNSURC).
+#ifndef GPS_NAV_URC
+#define GPS_NAV_URC 1
+#endif
+
+// Default GPS_URC_LIGHT_SLEEP to 0. 1 = light-sleep the CPU between +UGNSINF: reports
+// (timer wake GPS_URC_WAKE_MARGIN_MS before the next is due, UART activity as backstop).
+// Skipped while a concurrent wave collection runs on the other core.
+#ifndef GPS_URC_LIGHT_SLEEP
+#define GPS_URC_LIGHT_SLEEP 0
+#endif
+#ifndef GPS_URC_WAKE_MARGIN_MS
+#define GPS_URC_WAKE_MARGIN_MS 150
+#endif
+static const uart_port_t GPS_AT_UART = UART_NUM_1;  // SerialAT (Serial1)
+
+// Signal-based decisions from the satellite fields of each report (in view, used,
+// strongest C/N0). Early abort: no satellite at GPS_ABORT_CN0_DBHZ or better for the
+// last GPS_ABORT_WINDOW_S, checked from GPS_ABORT_AFTER_S on (flipped buoy, iced or
+// blocked antenna). 0 disables it.
+#ifndef GPS_ABORT_AFTER_S
+#define GPS_ABORT_AFTER_S 180
+#endif
+#ifndef GPS_ABORT_WINDOW_S
+#define GPS_ABORT_WINDOW_S 120
+#endif
+#ifndef GPS_ABORT_CN0_DBHZ
+#define GPS_ABORT_CN0_DBHZ 25
+#endif
+// Early accept: during the HDOP-gated search, a fix with HDOP up to GPS_EARLY_HDOP
+// is taken when at least GPS_EARLY_SATS satellites are used, the strongest is at
+// GPS_EARLY_CN0_DBHZ or better and the last GPS_EARLY_REPORTS fixes all lie within
+// GPS_EARLY_SPREAD_M of each other. GPS_EARLY_SATS 0 disables it.
+#ifndef GPS_EARLY_SATS
+#define GPS_EARLY_SATS 7
+#endif
+#ifndef GPS_EARLY_CN0_DBHZ
+#define GPS_EARLY_CN0_DBHZ 35
+#endif
+#ifndef GPS_EARLY_HDOP
+#define GPS_EARLY_HDOP 5.0f
+#endif
+#ifndef GPS_EARLY_REPORTS
+#define GPS_EARLY_REPORTS 5
+#endif
+#ifndef GPS_EARLY_SPREAD_M
+#define GPS_EARLY_SPREAD_M 15.0f
+#endif
+// Anchor refinement: an accepted fix that is borderline for the anchor drift test
+// (anchorTestBorderline) is averaged, HDOP-weighted, with up to GPS_ANCHOR_EXTRA_FIXES
+// more fixes read within GPS_ANCHOR_EXTRA_S before the engine stops. 0 disables it.
+#ifndef GPS_ANCHOR_EXTRA_FIXES
+#define GPS_ANCHOR_EXTRA_FIXES 5
+#endif
+#ifndef GPS_ANCHOR_EXTRA_S
+#define GPS_ANCHOR_EXTRA_S 15
+#endif
+
+// Learned acquisition timeout (GPS_TTF_LEARN): the GPS_TTF_PERCENTILE acquisition time
+// of past starts like this one, times GPS_TTF_MARGIN, once GPS_TTF_MIN_SAMPLES exist.
+// Never above the battery table in getGpsFixTimeout(), never below GPS_TTF_MIN_TIMEOUT_S.
+#ifndef GPS_TTF_LEARN
+#define GPS_TTF_LEARN 1
+#endif
+#ifndef GPS_TTF_PERCENTILE
+#define GPS_TTF_PERCENTILE 0.9f
+#endif
+#ifndef GPS_TTF_MARGIN
+#define GPS_TTF_MARGIN 1.5f
+#endif
+#ifndef GPS_TTF_MIN_SAMPLES
+#define GPS_TTF_MIN_SAMPLES 5
+#endif
+#ifndef GPS_TTF_MIN_TIMEOUT_S
+#define GPS_TTF_MIN_TIMEOUT_S 120
+#endif
+
+// Conditional XTRA refresh (GPS_XTRA_CONDITIONAL): a stale file is only refreshed for
+// a warm or cold start, and only after a conditional HEAD (validators from the last
+// download, kept in NVS) says the server has a newer one. 0 = download whenever stale.
+#ifndef GPS_XTRA_CONDITIONAL
+#define GPS_XTRA_CONDITIONAL 1
+#endif
+
+enum GnssStartMode : uint8_t { GNSS_HOT = 0, GNSS_WARM = 1, GNSS_COLD = 2 };
+static const char* const GNSS_START_NAMES[] = {"hot", "warm", "cold"};
+
 // Local state
 static Preferences s_prefs;
 static bool s_xtraJustApplied = false;  // Set when CGNSCOLD started engine with fresh XTRA
+static GnssStartMode s_startMode = GNSS_COLD;  // Mode of the last gnssStart()
+static GpsAcqStats s_lastAcq = {};              // Outcome of this wake's acquisition (upload)
+static GpsXtraStats s_lastXtra = {};            // This wake's XTRA decision and its cost (upload)
 
 // ---------- AT helpers ----------
 static void preATDelay() { delay(100); }
@@ -273,7 +375,9 @@ static void markXTRAJustApplied(const ClockInfo& nowCi) {
   s_prefs.end();
 }
 
-static bool downloadAndApplyXTRA() {
+// Downloads the file into the modem's flash and applies it. bytes and downloadMs are
+// set on a successful download, for the conditional refresh and its stats.
+static bool downloadAndApplyXTRA(uint32_t* bytes, uint32_t* downloadMs) {
   SerialMon.println("=== XTRA DOWNLOAD to /customer/ via HTTPTOFS ===");
   String cmd = String("AT+HTTPTOFS=\"") + XTRA_URL + "\",\"" + XTRA_FS_DST + "\"," +
                XTRA_HTTP_TIMEOUT_S + "," + XTRA_HTTP_RETRIES;
@@ -297,6 +401,8 @@ static bool downloadAndApplyXTRA() {
     // 6xx codes are modem-level errors (601=network, 602=DNS, 603=connect).
     if (err == 200 && sz > 0) {
       SerialMon.printf("XTRA downloaded: %ld bytes\n", sz);
+      *bytes = (uint32_t)sz;
+      *downloadMs = millis() - t0;
       ok = true;
     } else {
       SerialMon.printf("XTRA download failed: HTTP %d, size=%ld\n", err, sz);
@@ -329,6 +435,159 @@ static bool downloadAndApplyXTRA() {
   return true;
 }
 
+// Conditional HEAD for the XTRA file. HTTPTOFS can neither send request headers nor
+// return response headers, so this is raw HTTP over an AT+CAOPEN socket on the same
+// CNACT bearer. A 304 costs a few hundred bytes instead of the whole file.
+struct XtraProbe {
+  int status = 0;         // HTTP status; 0 = no answer (socket unsupported or failed)
+  String etag;            // Validators of the server's current file (200 only)
+  String lastModified;
+  uint32_t bytes = 0;     // Request + response headers
+};
+
+static String httpHeaderValue(const String& head, const char* name) {
+  String lower = head;
+  lower.toLowerCase();
+  String key = String("\r\n") + name + ":";
+  key.toLowerCase();
+  const int p = lower.indexOf(key);
+  if (p < 0) return String();
+  const int start = p + key.length();
+  int end = head.indexOf("\r\n", start);
+  if (end < 0) end = head.length();
+  String value = head.substring(start, end);
+  value.trim();
+  return value;
+}
+
+// Waits for token on the AT port, for the ">" prompt and OK after raw socket data
+static bool waitForAT(const char* token, uint32_t timeoutMs) {
+  String rsp;
+  const uint32_t t0 = millis();
+  while (millis() - t0 < timeoutMs) {
+    while (SerialAT.available()) {
+      rsp += (char)SerialAT.read();
+      if (rsp.indexOf(token) >= 0) return true;
+      if (rsp.indexOf("ERROR") >= 0) return false;
+    }
+    delay(10);
+  }
+  return false;
+}
+
+// One AT+CARECV=0,<maxLen>: appends the payload to data. The payload is taken by the
+// count in "+CARECV: <n>," rather than up to the OK, since header bytes may look like
+// AT responses. Returns the bytes read (0 = nothing buffered yet), -1 on ERROR/timeout.
+static int caRecv(uint16_t maxLen, String& data, uint32_t timeoutMs) {
+  preATDelay();
+  SerialAT.printf("AT+CARECV=0,%u\r\n", (unsigned)maxLen);
+  String line;    // Response text outside the payload
+  int n = -1;     // Payload length, once "+CARECV: " has been parsed
+  int left = 0;   // Payload bytes still to read
+  const uint32_t t0 = millis();
+  while (millis() - t0 < timeoutMs) {
+    while (SerialAT.available()) {
+      const char c = (char)SerialAT.read();
+      if (left > 0) {
+        data += c;
+        left--;
+        continue;
+      }
+      line += c;
+      if (n < 0) {
+        const int q = line.indexOf("+CARECV: ");
+        if (q < 0) {
+          if (line.indexOf("ERROR") >= 0) return -1;
+          continue;
+        }
+        const int comma = line.indexOf(',', q);
+        if (comma > 0) {
+          n = line.substring(q + 9, comma).toInt();
+          if (n < 0 || n > maxLen) return -1;
+          left = n;
+          line = "";
+        } else if (line.endsWith("\r\n")) {
+          n = 0;   // "+CARECV: 0": nothing buffered
+        }
+        continue;
+      }
+      if (line.indexOf("OK\r\n") >= 0) return n;
+      if (line.indexOf("ERROR") >= 0) return -1;
+    }
+    delay(5);
+  }
+  return -1;
+}
+
+// Status code of a complete response head ("HTTP/1.x <3 digits>[ <reason>]\r\n ...
+// \r\n\r\n"); 0 if the head was cut short or the status line is malformed
+static int httpStatus(const String& head) {
+  if (head.indexOf("\r\n\r\n") < 0) return 0;
+  const String line = head.substring(0, head.indexOf("\r\n"));
+  const int sp1 = line.indexOf(' ');
+  if (sp1 < 0 || !line.startsWith("HTTP/1.")) return 0;
+  int sp2 = line.indexOf(' ', sp1 + 1);
+  if (sp2 < 0) sp2 = line.length();
+  const String code = line.substring(sp1 + 1, sp2);
+  if (code.length() != 3) return 0;
+  for (unsigned i = 0; i < code.length(); i++) {
+    if (!isDigit(code[i])) return 0;
+  }
+  return code.toInt();
+}
+
+static XtraProbe xtraProbe(const String& etag, const String& lastModified) {
+  XtraProbe probe;
+  String hostPath = XTRA_URL;
+  if (hostPath.startsWith("http://")) hostPath = hostPath.substring(7);
+  const int slash = hostPath.indexOf('/');
+  const String host = slash < 0 ? hostPath : hostPath.substring(0, slash);
+  const String path = slash < 0 ? String("/") : hostPath.substring(slash);
+
+  String req = String("HEAD ") + path + " HTTP/1.1\r\nHost: " + host + "\r\nConnection: close\r\n";
+  if (etag.length()) req += String("If-None-Match: ") + etag + "\r\n";
+  if (lastModified.length()) req += String("If-Modified-Since: ") + lastModified + "\r\n";
+  req += "\r\n";
+
+  String rsp;
+  sendAT(String("AT+CAOPEN=0,\"TCP\",\"") + host + "\",80", &rsp, 15000);
+  if (rsp.indexOf("+CAOPEN: 0,0") < 0) {
+    SerialMon.println("XTRA probe: connect failed");
+    sendAT("AT+CACLOSE=0", nullptr, 2000);
+    return probe;
+  }
+  preATDelay();
+  SerialAT.printf("AT+CASEND=0,%u\r\n", (unsigned)req.length());
+  if (!waitForAT(">", 3000)) {
+    SerialMon.println("XTRA probe: no send prompt");
+    sendAT("AT+CACLOSE=0", nullptr, 2000);
+    return probe;
+  }
+  SerialAT.print(req);
+  waitForAT("OK", 3000);
+
+  // Read until the end of the response headers (HEAD has no body). A full read may
+  // leave more buffered, so read again at once; wait only when the modem has none.
+  String head;
+  const uint32_t t0 = millis();
+  while (millis() - t0 < 10000 && head.indexOf("\r\n\r\n") < 0 && head.length() < 4096) {
+    const int n = caRecv(512, head, 2000);
+    if (n < 0) break;
+    if (n == 0) delay(300);
+  }
+  sendAT("AT+CACLOSE=0", nullptr, 2000);
+
+  probe.bytes = req.length() + head.length();
+  probe.status = httpStatus(head);
+  if (probe.status == 200) {
+    probe.etag = httpHeaderValue(head, "ETag");
+    probe.lastModified = httpHeaderValue(head, "Last-Modified");
+  }
+  SerialMon.printf("XTRA probe: HTTP %d, %lu bytes%s%s\n", probe.status, (unsigned long)probe.bytes,
+                   probe.etag.length() ? ", ETag " : "", probe.etag.c_str());
+  return probe;
+}
+
 static bool xtraFileAvailable() {
   s_prefs.begin("xtra", true);
   long lastDay = s_prefs.getLong("last_day", -1);
@@ -336,6 +595,18 @@ static bool xtraFileAvailable() {
   return lastDay >= 0;
 }
 
+// Days since the XTRA file was downloaded, by the RTC; 255 if never or unknown
+static uint8_t xtraAgeDays() {
+  s_prefs.begin("xtra", true);
+  long lastDay = s_prefs.getLong("last_day", -1);
+  s_prefs.end();
+  time_t now = time(NULL);
+  if (lastDay < 0 || now <= 1000000000) return 255;
+  long age = (long)(now / SECONDS_PER_DAY) - lastDay;
+  if (age < 0 || age > 254) return 255;
+  return (uint8_t)age;
+}
+
 // ---------- GNSS helpers ----------
 static bool gnssEngineRunning() {
   String inf;
@@ -348,23 +619,24 @@ static bool gnssEngineRunning() {
 }
 
 // Determine best GNSS start mode based on last fix age
-static const char* gnssStartCommand() {
+static GnssStartMode gnssStartMode() {
   uint32_t lastFix = rtcState.lastGpsFixTime;
-  if (lastFix <= 1000000000) return "AT+CGNSCOLD";  // No prior fix — cold start
+  if (lastFix <= 1000000000) return GNSS_COLD;  // No prior fix — cold start
 
   uint32_t now = (uint32_t)time(NULL);
-  if (now <= 1000000000) return "AT+CGNSCOLD";      // RTC not set — cold start
+  if (now <= 1000000000) return GNSS_COLD;      // RTC not set — cold start
 
   uint32_t ageSec = now - lastFix;
-  if (ageSec < 4 * 3600) {
-    SerialMon.printf("Last fix %lu sec ago — hot start\n", ageSec);
-    return "AT+CGNSHOT";    // Ephemeris still valid (<4h)
-  } else if (ageSec < SECONDS_PER_DAY) {
-    SerialMon.printf("Last fix %lu sec ago — warm start\n", ageSec);
-    return "AT+CGNSWARM";   // Almanac valid, ephemeris stale
-  }
-  SerialMon.printf("Last fix %lu sec ago — cold start\n", ageSec);
-  return "AT+CGNSCOLD";     // Everything stale
+  GnssStartMode mode = GNSS_COLD;               // Everything stale
+  if (ageSec < 4 * 3600) mode = GNSS_HOT;       // Ephemeris still valid (<4h)
+  else if (ageSec < SECONDS_PER_DAY) mode = GNSS_WARM;  // Almanac valid, ephemeris stale
+  SerialMon.printf("Last fix %lu sec ago — %s start\n", ageSec, GNSS_START_NAMES[mode]);
+  return mode;
+}
+
+static const char* gnssStartCommand(GnssStartMode mode) {
+  static const char* const COMMANDS[] = {"AT+CGNSHOT", "AT+CGNSWARM", "AT+CGNSCOLD"};
+  return COMMANDS[mode];
 }
 
 static bool gnssStart() {
@@ -374,6 +646,7 @@ static bool gnssStart() {
   // Don't power-cycle — just configure NMEA output and verify.
   if (s_xtraJustApplied) {
     SerialMon.println("GNSS already started by XTRA CGNSCOLD — skipping power cycle");
+    s_startMode = GNSS_COLD;
     s_xtraJustApplied = false;
     sendAT("AT+CGNSNMEA=511");
     sendAT("AT+CGNSRTMS=1000");
@@ -400,7 +673,8 @@ static bool gnssStart() {
   }
 
   // Issue warm/hot/cold start based on last fix age
-  const char* startCmd = gnssStartCommand();
+  s_startMode = gnssStartMode();
+  const char* startCmd = gnssStartCommand(s_startMode);
   SerialMon.printf("GNSS start mode: %s\n", startCmd);
   sendAT(startCmd);
 
@@ -432,92 +706,486 @@ static bool gnssStart() {
 }
 
 static void gnssStop() {
+#if GPS_NAV_URC
+  sendAT("AT+CGNSURC=0", nullptr, 1500, /*echo*/false);
+#endif
   sendAT("AT+CGNSPWR=0");
+  // Drop any report that arrived behind the OK so later AT exchanges start clean
+  delay(50);
+  while (SerialAT.available()) SerialAT.read();
 }
 
-static bool parseCgnsInfFix(const String& inf, float* outLat, float* outLon, uint32_t* outEpoch, float* outHdop = nullptr) {
-  int p = inf.indexOf("+CGNSINF:"); if (p < 0) return false;
-  int start = inf.indexOf(':', p); if (start < 0) return false; start++;
-  // CGNSINF fields: 0=run, 1=fix, 2=utc, 3=lat, 4=lon, 5=alt, 6=speed, 7=course, 8=fixmode, 9=reserved, 10=HDOP
-  int field = 0; bool run=false, hasFix=false; double lat=0, lon=0; float hdop=99.0f, alt=0.0f; String ts;
-  String token; token.reserve(32);
-  for (int i = start; i <= (int)inf.length(); ++i) {
-    char c = (i == (int)inf.length()) ? ',' : inf[i];
-    if (c == ',') {
-      switch (field) {
-        case 0: run = (token.trim(), (token == "1")); break;
-        case 1: hasFix = (token.trim(), (token == "1")); break;
-        case 2: ts = token; break; // YYYYMMDDhhmmss.sss
-        case 3: lat = token.toDouble(); break;
-        case 4: lon = token.toDouble(); break;
-        case 5: alt = token.toFloat(); break;
-        case 10: { token.trim(); if (token.length() > 0) hdop = token.toFloat(); } break;
-        default: break;
+// ---------- Navigation reports ----------
+// One +UGNSINF: URC (AT+CGNSURC) or +CGNSINF: response; both carry the same fields:
+// 0=run, 1=fix, 2=utc, 3=lat, 4=lon, 5=alt, 6=speed, 7=course, 8=fixmode, 9=reserved, 10=HDOP,
+// 11=PDOP, 12=VDOP, 13=reserved, 14=satellites in view, 15=satellites used,
+// 16=GLONASS in view, 17=reserved, 18=C/N0 max (dB-Hz)
+struct GnssNavReport {
+  bool run;
+  bool fix;
+  double lat, lon;
+  float alt;
+  float hdop;          // 99 when the field is empty
+  char utc[20];        // YYYYMMDDhhmmss.sss
+  uint8_t satsInView;  // 0 when empty
+  uint8_t satsUsed;
+  uint8_t cn0Max;      // Strongest satellite, dB-Hz; 0 when empty (nothing tracked)
+};
+
+// Incremental report parser, fed one character at a time straight from the AT port.
+// Recognises report lines by their prefix and converts each field as its comma
+// arrives, so there is no String or line buffer; feed() returns true on the line end
+// that completes a report. Anything else on the port (OK, echoes, other URCs) is
+// skipped to the end of its line.
+class GnssNavParser {
+ public:
+  void reset() { state_ = PREFIX; pos_ = 0; }
+
+  bool feed(char c) {
+    if (c == '\r' || c == '\n') {
+      bool done = false;
+      if (state_ == FIELDS) {
+        endField();
+        done = (field_ >= 10);  // Truncated lines (no HDOP field) are dropped
+        if (done) report_ = work_;
       }
-      token = ""; field++;
-      if (field > 11) break;
-    } else {
-      token += c;
+      reset();
+      return done;
+    }
+    switch (state_) {
+      case PREFIX: {
+        static const char PATTERN[] = "+?GNSINF:";  // ? = U (URC) or C (response)
+        const char want = PATTERN[pos_];
+        if (c == want || (want == '?' && (c == 'U' || c == 'C'))) {
+          if (++pos_ == sizeof(PATTERN) - 1) {
+            state_ = FIELDS;
+            field_ = 0;
+            pos_ = 0;
+            work_ = {};
+            work_.hdop = 99.0f;
+          }
+        } else {
+          state_ = SKIP;
+        }
+        break;
+      }
+      case FIELDS:
+        if (c == ',') {
+          endField();
+          field_++;
+          pos_ = 0;
+        } else if (c != ' ' && pos_ < TOKEN_MAX) {
+          token_[pos_++] = c;
+        }
+        break;
+      case SKIP:
+        break;
+    }
+    return false;
+  }
+
+  const GnssNavReport& report() const { return report_; }
+
+ private:
+  enum State : uint8_t { PREFIX, FIELDS, SKIP };
+  static constexpr uint8_t TOKEN_MAX = 23;
+
+  void endField() {
+    token_[pos_] = '\0';
+    switch (field_) {
+      case 0: work_.run = (strcmp(token_, "1") == 0); break;
+      case 1: work_.fix = (strcmp(token_, "1") == 0); break;
+      case 2: strncpy(work_.utc, token_, sizeof(work_.utc) - 1); break;
+      case 3: work_.lat = strtod(token_, nullptr); break;
+      case 4: work_.lon = strtod(token_, nullptr); break;
+      case 5: work_.alt = strtof(token_, nullptr); break;
+      case 10: if (pos_ > 0) work_.hdop = strtof(token_, nullptr); break;
+      case 14: work_.satsInView = smallCount(); break;
+      case 15: work_.satsUsed = smallCount(); break;
+      case 18: work_.cn0Max = smallCount(); break;
+      default: break;
     }
   }
-  if (!(run && hasFix)) return false;
+
+  uint8_t smallCount() const {
+    const long v = strtol(token_, nullptr, 10);
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+  }
+
+  State state_ = PREFIX;
+  uint8_t pos_ = 0;     // Prefix characters matched, then length of the current field
+  uint8_t field_ = 0;
+  char token_[TOKEN_MAX + 1];
+  GnssNavReport work_{};
+  GnssNavReport report_{};
+};
+
+static int utcDigits(const char* s, int n) {
+  int v = 0;
+  for (int i = 0; i < n; ++i) v = v * 10 + (s[i] - '0');
+  return v;
+}
+
+// True if the report holds a plausible fix; sets *outEpoch from its UTC field (0 if absent)
+static bool navFixUsable(const GnssNavReport& r, uint32_t* outEpoch) {
+  if (!(r.run && r.fix)) return false;
   // Validate coordinates: reject (0,0) which is Null Island (common GPS default on no fix),
   // and reject anything outside valid geographic range (±90° lat, ±180° lon).
   // Note: ±180° is valid at antimeridian; ±90° are valid at poles.
-  if (lat == 0.0 && lon == 0.0) { SerialMon.println("GPS fix rejected: (0,0) Null Island"); return false; }
-  if (lat < -90.0 || lat > 90.0 || lon < -180.0 || lon > 180.0) {
-    SerialMon.printf("GPS fix rejected: out of range (lat=%.4f, lon=%.4f)\n", lat, lon);
+  if (r.lat == 0.0 && r.lon == 0.0) { SerialMon.println("GPS fix rejected: (0,0) Null Island"); return false; }
+  if (r.lat < -90.0 || r.lat > 90.0 || r.lon < -180.0 || r.lon > 180.0) {
+    SerialMon.printf("GPS fix rejected: out of range (lat=%.4f, lon=%.4f)\n", r.lat, r.lon);
     return false;
   }
   // Validate altitude: Norwegian lakes are ~0–600 m above sea level; altitude >5km indicates garbage fix
-  if (alt < -100.0f || alt > 5000.0f) {
-    SerialMon.printf("GPS fix rejected: altitude out of range (%.1f m)\n", alt);
+  if (r.alt < -100.0f || r.alt > 5000.0f) {
+    SerialMon.printf("GPS fix rejected: altitude out of range (%.1f m)\n", r.alt);
     return false;
   }
-  if (outLat) *outLat = (float)lat;
-  if (outLon) *outLon = (float)lon;
-  if (outHdop) *outHdop = hdop;
-  if (outEpoch && ts.length() >= 14) {
-    struct tm t{};
-    t.tm_year = ts.substring(0,4).toInt() - 1900;
-    t.tm_mon  = ts.substring(4,6).toInt() - 1;
-    t.tm_mday = ts.substring(6,8).toInt();
-    t.tm_hour = ts.substring(8,10).toInt();
-    t.tm_min  = ts.substring(10,12).toInt();
-    t.tm_sec  = ts.substring(12,14).toInt();
-    *outEpoch = makeEpochUTC(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+  *outEpoch = 0;
+  if (strlen(r.utc) >= 14) {
+    *outEpoch = makeEpochUTC(utcDigits(r.utc, 4), utcDigits(r.utc + 4, 2), utcDigits(r.utc + 6, 2),
+                             utcDigits(r.utc + 8, 2), utcDigits(r.utc + 10, 2), utcDigits(r.utc + 12, 2));
   }
   return true;
 }
 
-// Returns true and populates result if a fix was acquired during the warmup period.
-// Uses CGNSINF polling only — no NMEA streaming, avoiding UART contention.
-static bool gnssWarmup60s(GpsFixResult* outResult, uint32_t gnssStartTime) {
-  uint32_t tStart = millis();
-  SerialMon.println("GNSS warmup: polling CGNSINF for up to 60s...");
-  while (millis() - tStart < 60000) {
+// ---------- Acquisition ----------
+// Turns on the modem's per-fix navigation URC. False (poll instead) if disabled or rejected.
+static bool gnssEnableUrc() {
+#if GPS_NAV_URC
+  if (sendAT("AT+CGNSURC=1")) {
+#if GPS_URC_LIGHT_SLEEP
+    uart_set_wakeup_threshold(GPS_AT_UART, 3);
+#endif
+    return true;
+  }
+  SerialMon.println("CGNSURC not accepted — polling CGNSINF instead");
+#endif
+  return false;
+}
+
+// Idles until more of the next report can have arrived. With GPS_URC_LIGHT_SLEEP the
+// CPU light-sleeps through the gap after a report, waking GPS_URC_WAKE_MARGIN_MS before
+// the next one is due; UART activity also wakes it, at the cost of the characters
+// that do so, which is why only the idle gap is slept.
+static void gnssIdle(uint32_t lastReportMs) {
+#if GPS_URC_LIGHT_SLEEP
+  const int32_t sleepMs = (int32_t)(lastReportMs + GNSS_REPORT_MS - GPS_URC_WAKE_MARGIN_MS - millis());
+  if (sleepMs > 20 && !SerialAT.available() && !waveCollectedConcurrently()) {
+    SerialMon.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+    esp_sleep_enable_uart_wakeup(GPS_AT_UART);
+    esp_err_t err = esp_light_sleep_start();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_UART);
+    if (err == ESP_OK) return;
+  }
+#else
+  (void)lastReportMs;
+#endif
+  delay(10);
+}
+
+// Waits for the next navigation report until deadlineMs (millis()). URC mode feeds
+// the port into the parser as characters arrive; poll mode sends AT+CGNSINF once per
+// GNSS_REPORT_MS and feeds the response through the same parser.
+static bool gnssNextReport(GnssNavParser& parser, bool urc, uint32_t deadlineMs,
+                           uint32_t lastReportMs, uint32_t* lastPollMs) {
+  if (!urc) {
+    const uint32_t since = millis() - *lastPollMs;
+    if (since < GNSS_REPORT_MS) delay(GNSS_REPORT_MS - since);
+    *lastPollMs = millis();
     String inf;
-    if (sendAT("AT+CGNSINF", &inf, 1500, /*echo*/false)) {
-      float lat, lon, hdop; uint32_t epoch;
-      if (parseCgnsInfFix(inf, &lat, &lon, &epoch, &hdop)) {
-        if (outResult) {
-          outResult->success = true;
-          outResult->latitude = lat;
-          outResult->longitude = lon;
-          outResult->fixTimeEpoch = epoch;
-          outResult->hdop = hdop;
-          outResult->ttfSeconds = (uint16_t)((millis() - gnssStartTime) / 1000);
-          SerialMon.printf("GPS fix during warmup! HDOP=%.1f TTF=%us\n", hdop, outResult->ttfSeconds);
-        }
-        return true;
+    if (!sendAT("AT+CGNSINF", &inf, 1500, /*echo*/false)) return false;
+    parser.reset();
+    bool got = false;
+    for (unsigned i = 0; i < inf.length(); ++i) got |= parser.feed(inf[i]);
+    return got;
+  }
+  while ((int32_t)(deadlineMs - millis()) > 0) {
+    while (SerialAT.available()) {
+      if (parser.feed((char)SerialAT.read())) return true;
+    }
+    gnssIdle(lastReportMs);
+  }
+  return false;
+}
+
+static void logSearchTime(uint32_t elapsedSec) {
+  if (elapsedSec >= 60) {
+    uint32_t minutes = elapsedSec / 60; uint32_t seconds = elapsedSec % 60;
+    if (seconds == 0) SerialMon.printf("Searched for GPS fix for %lu minute%s\n", minutes, minutes == 1 ? "" : "s");
+    else SerialMon.printf("Searched for GPS fix for %lu minute%s and %lu second%s\n", minutes, minutes == 1 ? "" : "s", seconds, seconds == 1 ? "" : "s");
+  } else {
+    SerialMon.printf("Searched for GPS fix for %lu seconds\n", elapsedSec);
+  }
+}
+
+// Acquisition phases, by time since the engine started:
+//   WARMUP  0..60s                       any valid fix is accepted
+//   SEARCH  60s..60s + 80% of timeout    only fixes with HDOP ≤ HDOP_ACCEPT_THRESHOLD
+//   GRACE   until 60s + timeout          any valid fix again (better than nothing)
+// Each report is judged as it arrives, so a qualifying fix ends the search at once.
+// Any phase ends early on no usable signal; SEARCH also takes a stable fix from
+// enough strong satellites (see GPS_ABORT_* / GPS_EARLY_*).
+enum class GnssPhase : uint8_t { WARMUP, SEARCH, GRACE };
+
+// Consecutive fixes within GPS_EARLY_SPREAD_M of the first of the run
+struct GnssFixRun {
+  double lat0 = 0.0, lon0 = 0.0;
+  uint8_t count = 0;
+
+  void add(double lat, double lon) {
+    // Equirectangular distance; exact enough at metre scale
+    const double dy = (lat - lat0) * 111195.0;
+    const double dx = (lon - lon0) * 111195.0 * cos(lat0 * (M_PI / 180.0));
+    if (count == 0 || dx * dx + dy * dy > (double)GPS_EARLY_SPREAD_M * GPS_EARLY_SPREAD_M) {
+      lat0 = lat;
+      lon0 = lon;
+      count = 0;
+    }
+    if (count < 255) count++;
+  }
+};
+
+// Averages a borderline fix with the next few so one jumpy epoch can neither raise nor
+// hide a drift alarm. Consecutive fixes share most of their error, so the result keeps
+// the weighted mean HDOP rather than claiming a √n improvement.
+static void gnssRefineForAnchor(GnssNavParser& parser, bool urc, uint32_t* lastPollMs,
+                                GpsFixResult* result) {
+  if (GPS_ANCHOR_EXTRA_FIXES == 0 ||
+      !anchorTestBorderline(result->latitude, result->longitude, result->hdop)) return;
+  SerialMon.printf("Fix is borderline for the anchor drift test — averaging up to %u more fixes\n",
+                   (unsigned)GPS_ANCHOR_EXTRA_FIXES);
+  // Weight 1/HDOP², HDOP floored so an empty field cannot take over the mean
+  auto weight = [](float hdop) { const double h = fmax((double)hdop, 0.5); return 1.0 / (h * h); };
+  double w = weight(result->hdop);
+  double sw = w, slat = w * result->latitude, slon = w * result->longitude, shdop = w * result->hdop;
+  uint8_t fixes = 1;
+  const uint32_t deadline = millis() + GPS_ANCHOR_EXTRA_S * 1000UL;
+  uint32_t lastReportMs = millis();
+  while (fixes <= GPS_ANCHOR_EXTRA_FIXES && (int32_t)(deadline - millis()) > 0) {
+    if (!gnssNextReport(parser, urc, deadline, lastReportMs, lastPollMs)) continue;
+    lastReportMs = millis();
+    const GnssNavReport& r = parser.report();
+    uint32_t epoch;
+    if (!navFixUsable(r, &epoch)) continue;
+    w = weight(r.hdop);
+    sw += w; slat += w * r.lat; slon += w * r.lon; shdop += w * r.hdop;
+    fixes++;
+  }
+  if (fixes == 1) {
+    SerialMon.println("  No further fixes — keeping the first one");
+    return;
+  }
+  result->latitude = (float)(slat / sw);
+  result->longitude = (float)(slon / sw);
+  result->hdop = (float)(shdop / sw);
+  SerialMon.printf("  Averaged %u fixes: lat=%.6f, lon=%.6f, HDOP=%.1f\n",
+                   fixes, result->latitude, result->longitude, result->hdop);
+}
+
+static const char* const GPS_ACQ_NAMES[] = {"none", "warmup", "hdop", "stable", "grace", "no_signal", "timeout"};
+
+static bool gnssAcquire(GpsFixResult* result, uint32_t timeoutMs, uint32_t gnssStartTime) {
+  const bool urc = gnssEnableUrc();
+  const uint32_t graceAtMs = GNSS_WARMUP_MS + (uint32_t)(timeoutMs * 0.8f);
+  const uint32_t endAtMs = GNSS_WARMUP_MS + timeoutMs;
+  GnssNavParser parser;
+  GnssPhase phase = GnssPhase::WARMUP;
+  GnssFixRun fixRun;
+  const uint32_t start = millis();
+  uint32_t lastReportMs = start, lastPollMs = start - GNSS_REPORT_MS;
+  uint32_t lastStrongMs = start;  // Last report with a satellite at GPS_ABORT_CN0_DBHZ
+  uint32_t nextStatusMs = GNSS_STATUS_MS;
+  uint32_t reports = 0;
+  GpsAcqStats& acq = s_lastAcq;
+  acq = {};
+  auto finish = [&](GpsAcqOutcome outcome) {
+    acq.outcome = outcome;
+    acq.seconds = (uint16_t)((millis() - start) / 1000);
+    acq.satsUsed = parser.report().satsUsed;
+  };
+
+  SerialMon.printf("GNSS acquisition (%s): 60s warmup, then up to %lus with HDOP gate\n",
+                   urc ? "CGNSURC reports" : "polling CGNSINF", (unsigned long)(timeoutMs / 1000));
+
+  // No watchdog reset in this loop — intentional. The 45-minute WDT is the safety
+  // net that prevents the buoy from burning battery forever in bad weather. If we
+  // can't get a fix within the WDT window, it's better to reset and sleep.
+  for (;;) {
+    const uint32_t elapsed = millis() - start;
+    if (elapsed >= endAtMs) break;
+    if (phase == GnssPhase::WARMUP && elapsed >= GNSS_WARMUP_MS) {
+      SerialMon.println("GNSS warmup: no fix after 60s — starting GPS fix acquisition...");
+      phase = GnssPhase::SEARCH;
+    }
+    if (phase == GnssPhase::SEARCH && elapsed >= graceAtMs) {
+      SerialMon.printf("GNSS: past %lus grace point, accepting any HDOP\n", (unsigned long)(graceAtMs / 1000));
+      phase = GnssPhase::GRACE;
+    }
+    if (GPS_ABORT_AFTER_S > 0 && elapsed >= GPS_ABORT_AFTER_S * 1000UL &&
+        millis() - lastStrongMs >= GPS_ABORT_WINDOW_S * 1000UL) {
+      finish(GPS_ACQ_NO_SIGNAL);
+      SerialMon.printf("GNSS abort: no satellite ≥%u dB-Hz for %us (peak %u dB-Hz, %u in view) after %us\n",
+                       GPS_ABORT_CN0_DBHZ, GPS_ABORT_WINDOW_S, acq.cn0Max, acq.satsInView, acq.seconds);
+      return false;
+    }
+    if (elapsed >= nextStatusMs) {
+      const GnssNavReport& last = parser.report();
+      logSearchTime(elapsed / 1000);
+      if (reports > 0) {
+        SerialMon.printf("  GNSS status: %lu reports, last run=%d fix=%d HDOP=%.1f sats %u/%u C/N0 %u dB-Hz\n",
+                         (unsigned long)reports, last.run, last.fix, last.hdop,
+                         last.satsUsed, last.satsInView, last.cn0Max);
+      } else {
+        SerialMon.println("  GNSS status: no navigation reports yet");
+      }
+      nextStatusMs += GNSS_STATUS_MS;
+    }
+
+    // Wake at least every 2 reports so phase changes and status logs stay on time
+    const uint32_t deadline = millis() + 2 * GNSS_REPORT_MS;
+    if (!gnssNextReport(parser, urc, deadline, lastReportMs, &lastPollMs)) continue;
+    lastReportMs = millis();
+    reports++;
+
+    const GnssNavReport& r = parser.report();
+    if (r.cn0Max >= GPS_ABORT_CN0_DBHZ) lastStrongMs = lastReportMs;
+    if (r.cn0Max > acq.cn0Max) acq.cn0Max = r.cn0Max;
+    if (r.satsInView > acq.satsInView) acq.satsInView = r.satsInView;
+    uint32_t epoch;
+    if (!navFixUsable(r, &epoch)) {
+      fixRun.count = 0;
+      continue;
+    }
+    fixRun.add(r.lat, r.lon);
+    const bool hdopOk = (r.hdop <= HDOP_ACCEPT_THRESHOLD);
+    bool stable = false;
+    if (phase == GnssPhase::SEARCH && !hdopOk) {
+      stable = GPS_EARLY_SATS > 0 && r.hdop <= GPS_EARLY_HDOP && r.satsUsed >= GPS_EARLY_SATS &&
+               r.cn0Max >= GPS_EARLY_CN0_DBHZ && fixRun.count >= GPS_EARLY_REPORTS;
+      if (!stable) {
+        SerialMon.printf("GPS fix has HDOP=%.1f (want ≤%.1f), waiting for better fix...\n", r.hdop, HDOP_ACCEPT_THRESHOLD);
+        continue;
       }
     }
-    delay(1000);
+
+    result->success = true;
+    result->latitude = (float)r.lat;
+    result->longitude = (float)r.lon;
+    result->fixTimeEpoch = epoch;
+    result->hdop = r.hdop;
+    result->ttfSeconds = (uint16_t)((millis() - gnssStartTime) / 1000);
+    if (phase == GnssPhase::WARMUP) {
+      finish(GPS_ACQ_WARMUP);
+      SerialMon.printf("GPS fix during warmup! HDOP=%.1f TTF=%us\n", r.hdop, result->ttfSeconds);
+    } else if (stable) {
+      finish(GPS_ACQ_STABLE);
+      SerialMon.printf("GPS fix accepted early (HDOP=%.1f, %u sats used, C/N0 %u dB-Hz, %u fixes within %.0fm) TTF=%us\n",
+                       r.hdop, r.satsUsed, r.cn0Max, fixRun.count, GPS_EARLY_SPREAD_M, result->ttfSeconds);
+    } else if (!hdopOk) {
+      finish(GPS_ACQ_GRACE);
+      SerialMon.printf("GPS fix accepted (HDOP=%.1f, past grace period) TTF=%us\n", r.hdop, result->ttfSeconds);
+    } else {
+      finish(GPS_ACQ_HDOP);
+      SerialMon.printf("GPS fix acquired! HDOP=%.1f TTF=%us\n", r.hdop, result->ttfSeconds);
+    }
+    gnssRefineForAnchor(parser, urc, &lastPollMs, result);
+    return true;
   }
-  SerialMon.println("GNSS warmup: no fix after 60s");
+  finish(GPS_ACQ_TIMEOUT);
+  SerialMon.printf("GNSS acquisition timed out after %lu reports (peak C/N0 %u dB-Hz, %u in view)\n",
+                   (unsigned long)reports, acq.cn0Max, acq.satsInView);
   return false;
 }
 
+// ---------- Learned timeout ----------
+// An acquisition "made it" if its fix was accepted on merit: during the warmup, by the
+// HDOP gate, or by the early stable accept (HDOP up to 5). Grace fixes and timeouts are
+// misses, ranked above every success, so a site that keeps failing keeps the full
+// battery budget. Samples without an outcome (older firmware) are judged by HDOP.
+static bool ttfSampleHit(const GpsTtfSample& s) {
+  switch (s.outcome) {
+    case GPS_ACQ_WARMUP:
+    case GPS_ACQ_HDOP:
+    case GPS_ACQ_STABLE:
+      return true;
+    case GPS_ACQ_GRACE:
+    case GPS_ACQ_NO_SIGNAL:
+    case GPS_ACQ_TIMEOUT:
+      return false;
+    default:
+      if (s.hdopX10 == 255) return false;
+      return s.seconds < GNSS_WARMUP_MS / 1000 || s.hdopX10 <= (uint8_t)(HDOP_ACCEPT_THRESHOLD * 10.0f);
+  }
+}
+
+// Cold starts depend on XTRA, so they only learn from cold starts with the same
+// XTRA state (fresh vs stale/none); hot and warm starts ignore it.
+static bool ttfSampleMatches(const GpsTtfSample& s, GnssStartMode mode, uint8_t xtraAge) {
+  if (s.startMode != mode) return false;
+  if (mode != GNSS_COLD) return true;
+  return (s.xtraAgeDays < XTRA_STALE_DAYS) == (xtraAge < XTRA_STALE_DAYS);
+}
+
+// Search time after the warmup (seconds) for a start in this mode: GPS_TTF_MARGIN times
+// the GPS_TTF_PERCENTILE acquisition time of matching history, less the warmup it
+// already covers. capSec (battery budget) if the history is too short or the
+// percentile falls on a miss.
+static uint16_t learnedGpsTimeout(uint16_t capSec, GnssStartMode mode, uint8_t xtraAge) {
+#if GPS_TTF_LEARN
+  uint16_t secs[GPS_TTF_HISTORY];
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < rtcState.gpsTtfCount && i < GPS_TTF_HISTORY; ++i) {
+    const GpsTtfSample& s = rtcState.gpsTtfHistory[i];
+    if (!ttfSampleMatches(s, mode, xtraAge)) continue;
+    // Insertion sort; misses sort last
+    const uint16_t v = ttfSampleHit(s) ? s.seconds : UINT16_MAX;
+    uint8_t j = n++;
+    while (j > 0 && secs[j - 1] > v) { secs[j] = secs[j - 1]; --j; }
+    secs[j] = v;
+  }
+  if (n < GPS_TTF_MIN_SAMPLES) {
+    SerialMon.printf("GPS timeout: %us (battery budget; %u/%u %s starts in TTF history)\n",
+                     capSec, n, GPS_TTF_MIN_SAMPLES, GNSS_START_NAMES[mode]);
+    return capSec;
+  }
+  uint8_t k = (uint8_t)ceilf(GPS_TTF_PERCENTILE * n);
+  k = (k > 0) ? (uint8_t)(k - 1) : 0;
+  if (secs[k] == UINT16_MAX) {
+    SerialMon.printf("GPS timeout: %us (battery budget; p%.0f of %u %s starts is a miss)\n",
+                     capSec, GPS_TTF_PERCENTILE * 100.0f, n, GNSS_START_NAMES[mode]);
+    return capSec;
+  }
+  const float searchSec = GPS_TTF_MARGIN * secs[k] - GNSS_WARMUP_MS / 1000.0f;
+  uint16_t timeoutSec = (searchSec > (float)GPS_TTF_MIN_TIMEOUT_S) ? (uint16_t)searchSec : GPS_TTF_MIN_TIMEOUT_S;
+  if (timeoutSec > capSec) timeoutSec = capSec;
+  SerialMon.printf("GPS timeout: %us learned (p%.0f %us of %u %s starts, budget %us)\n",
+                   timeoutSec, GPS_TTF_PERCENTILE * 100.0f, secs[k], n, GNSS_START_NAMES[mode], capSec);
+  return timeoutSec;
+#else
+  (void)mode; (void)xtraAge;
+  return capSec;
+#endif
+}
+
+static void recordTtfSample(const GpsFixResult& result, uint32_t acqMs, uint8_t xtraAge) {
+  GpsTtfSample s;
+  const uint32_t secs = acqMs / 1000;
+  s.seconds = (secs > 65534) ? 65534 : (uint16_t)secs;
+  s.startMode = s_startMode;
+  s.xtraAgeDays = xtraAge;
+  s.hdopX10 = 255;
+  s.outcome = s_lastAcq.outcome;
+  if (result.success) {
+    const float h = result.hdop * 10.0f + 0.5f;
+    s.hdopX10 = (h < 254.0f) ? (uint8_t)h : 254;
+  }
+  pushGpsTtfSample(s);
+}
+
 // ---------- Public API ----------
 // (gpsBegin removed; not needed)
 
@@ -559,6 +1227,75 @@ void gpsNtpSync() {
 //
 void gpsEnd() { gnssStop(); }
 
+// Refreshes the XTRA file when it is stale and the coming start can use it, and fills
+// s_lastXtra with the bytes and seconds this cost against the old unconditional
+// download (estimated from the last measured download; 0 until there is one).
+static void refreshXTRA(const ClockInfo& nowCi) {
+  GpsXtraStats& x = s_lastXtra;
+  x = {};
+  if (!shouldDownloadXTRA(nowCi)) {
+    x.outcome = GPS_XTRA_FRESH;
+    return;
+  }
+  const long today = daysFromCivil(nowCi.year, nowCi.month, nowCi.day);
+  s_prefs.begin("xtra", true);
+  const uint32_t estBytes = s_prefs.getULong("size", 0);
+  const uint32_t estMs = s_prefs.getULong("dl_ms", 0);
+  const long checkedDay = s_prefs.getLong("chk_day", -1);
+  String etag = s_prefs.getString("etag", "");
+  String lastModified = s_prefs.getString("lastmod", "");
+  s_prefs.end();
+
+  uint32_t spentBytes = 0;
+  const uint32_t t0 = millis();
+  if (GPS_XTRA_CONDITIONAL && gnssStartMode() == GNSS_HOT) {
+    // Broadcast ephemeris is still current: a hot start never reads XTRA
+    SerialMon.println("XTRA refresh skipped: hot start does not use it");
+    x.outcome = GPS_XTRA_HOT;
+  } else if (GPS_XTRA_CONDITIONAL && checkedDay == today) {
+    SerialMon.println("XTRA refresh skipped: server had no newer file earlier today");
+    x.outcome = GPS_XTRA_UNCHANGED;
+  } else {
+    XtraProbe probe;
+    if (GPS_XTRA_CONDITIONAL) probe = xtraProbe(etag, lastModified);
+    spentBytes = probe.bytes;
+    if (probe.status == 304) {
+      // Same file as the one in modem flash: keep its age, just don't ask again today
+      s_prefs.begin("xtra", false);
+      s_prefs.putLong("chk_day", today);
+      s_prefs.end();
+      x.outcome = GPS_XTRA_UNCHANGED;
+    } else {
+      // 200, or no usable answer (socket commands unsupported): download as before
+      uint32_t fileBytes = 0, downloadMs = 0;
+      if (downloadAndApplyXTRA(&fileBytes, &downloadMs)) {
+        markXTRAJustApplied(nowCi);
+        s_prefs.begin("xtra", false);
+        s_prefs.putULong("size", fileBytes);
+        s_prefs.putULong("dl_ms", downloadMs);
+        if (probe.status == 200) {
+          s_prefs.putString("etag", probe.etag);
+          s_prefs.putString("lastmod", probe.lastModified);
+        }
+        s_prefs.end();
+        spentBytes += fileBytes;
+        x.outcome = GPS_XTRA_DOWNLOADED;
+      } else {
+        x.outcome = GPS_XTRA_FAILED;
+      }
+    }
+  }
+  x.bytes = spentBytes;
+  x.seconds = (uint16_t)((millis() - t0 + 500) / 1000);
+  if (estBytes > 0) {
+    x.savedBytes = (int32_t)estBytes - (int32_t)spentBytes;
+    x.savedSeconds = (int16_t)(((int32_t)estMs - (int32_t)(millis() - t0)) / 1000);
+  }
+  SerialMon.printf("XTRA refresh: %s, %lu bytes in %us (saved ~%ld bytes, ~%ds vs. unconditional download)\n",
+                   gpsXtraOutcomeName(x.outcome), (unsigned long)x.bytes, x.seconds,
+                   (long)x.savedBytes, x.savedSeconds);
+}
+
 static void syncTimeAndMaybeApplyXTRA() {
   // In minimal mode we may skip time/XTRA later via a guard in main; this function remains unchanged otherwise
   ClockInfo nowCi{};
@@ -579,9 +1316,7 @@ static void syncTimeAndMaybeApplyXTRA() {
       } else {
         SerialMon.println("XTRA skipped: NTP returned invalid clock data (CCLK parse failed)");
       }
-      if (nowCi.valid && shouldDownloadXTRA(nowCi)) {
-        if (downloadAndApplyXTRA()) markXTRAJustApplied(nowCi);
-      }
+      if (nowCi.valid) refreshXTRA(nowCi);
     } else {
       SerialMon.println("XTRA skipped: no valid clock (NTP failed, no NITZ from network)");
     }
@@ -593,7 +1328,7 @@ static void syncTimeAndMaybeApplyXTRA() {
 
 //
 // PUBLIC FUNCTION: getGpsFix
-// Acquires GPS/GNSS position with full pipeline: NTP → XTRA → warmup → polling.
+// Acquires GPS/GNSS position with full pipeline: NTP → XTRA → warmup → fix search.
 // Returns lat/lon if successful within timeout, otherwise returns zeros with success=false.
 // GNSS engine is shut down before returning.
 //
@@ -609,83 +1344,37 @@ GpsFixResult getGpsFix(uint16_t timeoutSec) {
     SerialMon.println("GNSS engine NOT running ❌ (continuing anyway)");
   }
 
-  // Warmup: poll CGNSINF for up to 60s (no NMEA streaming — avoids UART contention)
-  if (gnssWarmup60s(&result, gnssStartTime)) {
-    // Fix acquired during warmup — skip redundant polling
-    gnssStop();
-    return result;
-  }
-
-  // Attempt fix up to timeoutSec by polling CGNSINF
-  uint32_t start = millis();
-  uint32_t timeoutMs = timeoutSec * 1000UL;
-  uint32_t nextProgressSec = 30;  // Log every 30s
-  uint32_t lastInfLog = 0; bool firstInfLog = true;
-
-  // HDOP quality gate: accept fix immediately if HDOP is good enough.
-  // After 80% of timeout, accept any fix regardless of HDOP (better than nothing).
-  uint32_t hdopGraceMs = (uint32_t)(timeoutMs * 0.8f);
-
-  // No watchdog reset in this loop — intentional. The 45-minute WDT is the safety
-  // net that prevents the buoy from burning battery forever in bad weather. If we
-  // can't get a fix within the WDT window, it's better to reset and sleep.
-  SerialMon.println("Starting GPS fix acquisition...");
-  while ((millis() - start) < timeoutMs) {
-    String inf;
-    if (sendAT("AT+CGNSINF", &inf, 1500, /*echo*/false)) {
-      float lat, lon, hdop; uint32_t epoch;
-      if (parseCgnsInfFix(inf, &lat, &lon, &epoch, &hdop)) {
-        uint32_t elapsed = millis() - start;
-        bool hdopOk = (hdop <= HDOP_ACCEPT_THRESHOLD);
-        bool pastGrace = (elapsed >= hdopGraceMs);
-
-        if (hdopOk || pastGrace) {
-          result.success = true; result.latitude = lat; result.longitude = lon; result.fixTimeEpoch = epoch;
-          result.hdop = hdop;
-          result.ttfSeconds = (uint16_t)((millis() - gnssStartTime) / 1000);
-          if (!hdopOk) {
-            SerialMon.printf("GPS fix accepted (HDOP=%.1f, past grace period) TTF=%us\n", hdop, result.ttfSeconds);
-          } else {
-            SerialMon.printf("GPS fix acquired! HDOP=%.1f TTF=%us\n", hdop, result.ttfSeconds);
-          }
-          break;
-        } else {
-          SerialMon.printf("GPS fix has HDOP=%.1f (want ≤%.1f), waiting for better fix...\n", hdop, HDOP_ACCEPT_THRESHOLD);
-        }
-      }
-    }
-
-    if (millis() - lastInfLog >= 30000) {
-      String inf2;
-      if (sendAT("AT+CGNSINF", &inf2, 1500, /*echo*/true)) {
-        if (firstInfLog) { SerialMon.println("=== GPS Status Monitoring ==="); firstInfLog = false; }
-        SerialMon.printf("CGNSINF: %s\n", inf2.c_str());
-      }
-      lastInfLog = millis();
-    }
+  // Timeout for this start from the TTF history, capped by the battery budget
+  const uint8_t xtraAge = xtraAgeDays();
+  const uint16_t searchSec = learnedGpsTimeout(timeoutSec, s_startMode, xtraAge);
 
-    uint32_t elapsedSec = (millis() - start) / 1000UL;
-    if (elapsedSec >= nextProgressSec) {
-      if (elapsedSec >= 60) {
-        uint32_t minutes = elapsedSec / 60; uint32_t seconds = elapsedSec % 60;
-        if (seconds == 0) SerialMon.printf("Searched for GPS fix for %lu minute%s\n", minutes, minutes == 1 ? "" : "s");
-        else SerialMon.printf("Searched for GPS fix for %lu minute%s and %lu second%s\n", minutes, minutes == 1 ? "" : "s", seconds, seconds == 1 ? "" : "s");
-      } else {
-        SerialMon.printf("Searched for GPS fix for %lu seconds\n", elapsedSec);
-      }
-      nextProgressSec += 30;
-    }
-    delay(1000);
-  }
+  // Warmup and fix search in one pass over the navigation reports
+  gnssAcquire(&result, searchSec * 1000UL, gnssStartTime);
+  // An abort for lack of signal says nothing about how long a fix takes here.
+  // Acquisition time up to the accepted fix, without any anchor refinement after it.
+  if (s_lastAcq.outcome != GPS_ACQ_NO_SIGNAL) recordTtfSample(result, s_lastAcq.seconds * 1000UL, xtraAge);
 
   // GNSS off here; main will bring PDP up to upload
   gnssStop();
   return result;
 }
 
+GpsAcqStats getGpsAcqStats() { return s_lastAcq; }
+const char* gpsAcqOutcomeName(GpsAcqOutcome outcome) {
+  return (outcome <= GPS_ACQ_TIMEOUT) ? GPS_ACQ_NAMES[outcome] : "?";
+}
+
+GpsXtraStats getGpsXtraStats() { return s_lastXtra; }
+const char* gpsXtraOutcomeName(GpsXtraOutcome outcome) {
+  static const char* const NAMES[] = {"none", "fresh", "hot", "unchanged", "downloaded", "failed"};
+  return (outcome <= GPS_XTRA_FAILED) ? NAMES[outcome] : "?";
+}
+
 //
 // PUBLIC FUNCTION: getGpsFixTimeout
 // Returns appropriate timeout (seconds) based on battery level and fix type.
+// This is the energy budget: once the start mode is known, getGpsFix() shortens it
+// to what this buoy's TTF history needs (learnedGpsTimeout(), GPS_TTF_LEARN).
 // Cold-start (isFirstFix=true): longer timeouts (up to 30 min at full charge)
 // Warm fix (isFirstFix=false): shorter timeouts (5-10 min, XTRA already cached)
 // Low battery (<30%): very short timeout (2 min, skip GPS to preserve power)
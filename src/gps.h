@@ -4,7 +4,8 @@
 
 //
 // GPS/GNSS subsystem — integrated with modem (SIM7000G).
-// Pipeline: NTP sync → XTRA ephemeris download → 60s warmup → fix polling.
+// Pipeline: NTP sync → XTRA ephemeris download → fix acquisition (60s warmup, then HDOP gate)
+// driven by the modem's per-second navigation URC (AT+CGNSURC).
 // GNSS power controlled via AT commands (AT+CGNSPWR, AT+SGPIO, AT+CGPIO).
 // No ESP32 GPIO control — GPIO 4 is MODEM_PWRKEY, not a separate GPS power pin.
 //
@@ -25,10 +26,56 @@ typedef struct {
 //
 
 // Attempts to acquire a GPS fix within the specified timeout.
-// Full pipeline: NTP sync → XTRA ephemeris → 60s warmup → fix polling.
+// Full pipeline: NTP sync → XTRA ephemeris → 60s warmup + timeoutSec fix search.
 // Returns GpsFixResult with lat/lon if successful, or zeros if timeout/failure.
 GpsFixResult getGpsFix(uint16_t timeoutSec = 1800);
 
+// How this wake's acquisition ended, with the satellite figures it was judged on.
+// Logged by getGpsFix() and uploaded as gps.acq, acq_s, sv, su, cn0.
+enum GpsAcqOutcome : uint8_t {
+  GPS_ACQ_NONE = 0,   // No acquisition this wake
+  GPS_ACQ_WARMUP,     // Fix during the 60s warmup (any HDOP)
+  GPS_ACQ_HDOP,       // Fix passed the HDOP gate
+  GPS_ACQ_STABLE,     // Early accept: stable fix from enough strong satellites
+  GPS_ACQ_GRACE,      // Fix accepted past the grace point (any HDOP)
+  GPS_ACQ_NO_SIGNAL,  // Early abort: no usable satellite signal
+  GPS_ACQ_TIMEOUT,    // No acceptable fix before the timeout
+};
+
+typedef struct {
+  GpsAcqOutcome outcome;
+  uint16_t seconds;     // Acquisition time (after gnssStart)
+  uint8_t satsInView;   // Peak satellites in view
+  uint8_t satsUsed;     // Satellites used in the last report
+  uint8_t cn0Max;       // Strongest C/N0 seen (dB-Hz)
+} GpsAcqStats;
+
+GpsAcqStats getGpsAcqStats();
+const char* gpsAcqOutcomeName(GpsAcqOutcome outcome);  // "warmup", "hdop", "stable", ...
+
+// What this wake did about the XTRA file, and what that saved against downloading it
+// whenever stale. Logged by getGpsFix() and uploaded as gps.xtra, xtra_b, xtra_s,
+// xtra_saved_b, xtra_saved_s.
+enum GpsXtraOutcome : uint8_t {
+  GPS_XTRA_NONE = 0,     // No XTRA decision this wake (no GPS, no clock or no data connection)
+  GPS_XTRA_FRESH,        // File younger than 3 days, nothing to do
+  GPS_XTRA_HOT,          // Stale, but skipped: a hot start does not use it
+  GPS_XTRA_UNCHANGED,    // Stale, but the server has no newer file (304, or already asked today)
+  GPS_XTRA_DOWNLOADED,   // New file downloaded and applied
+  GPS_XTRA_FAILED,       // Download failed
+};
+
+typedef struct {
+  GpsXtraOutcome outcome;
+  uint32_t bytes;        // Transferred this wake (probe + download)
+  uint16_t seconds;      // Spent on the probe and download
+  int32_t savedBytes;    // Estimated against an unconditional download (negative = probe overhead)
+  int16_t savedSeconds;
+} GpsXtraStats;
+
+GpsXtraStats getGpsXtraStats();
+const char* gpsXtraOutcomeName(GpsXtraOutcome outcome);  // "fresh", "hot", "unchanged", ...
+
 // Shuts down GNSS engine via AT+CGNSPWR=0.
 // Must be called before returning modem to cellular-only mode (PDP teardown).
 void gpsEnd();
@@ -38,6 +85,8 @@ void gpsEnd();
 //
 
 // Returns appropriate GPS timeout (seconds) based on battery level and first/warm fix.
+// This is the energy budget; getGpsFix() learns a shorter timeout per start mode
+// from the TTF history in rtcState (GPS_TTF_LEARN) and never exceeds this one.
 // Cold-start (first fix): longer timeout (~30 min) despite high power cost.
 // Warm fix (XTRA cached): shorter timeout (~10 min) — quicker reacquisition.
 // Low battery (<30%): very short timeout (~2 min) — skip GPS to preserve power.
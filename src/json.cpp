@@ -5,8 +5,25 @@
 #include "power.h"
 #include "battery.h"
 #include "wave.h"
+#include "gps.h"
 #include <time.h>
 
+// Attach this wake's wave-band spectrum (wave.spec, ~150 bytes) for server-side
+// reprocessing
+#ifndef WAVE_UPLOAD_SPECTRUM
+#define WAVE_UPLOAD_SPECTRUM 0
+#endif
+
+// Attach the moment-based sea-state parameters (wave.tm01, tm02, te, nu, eps, qp)
+#ifndef WAVE_UPLOAD_MOMENTS
+#define WAVE_UPLOAD_MOMENTS 0
+#endif
+
+// Adaptive wave window (see wave.cpp; same default): only then does its length vary
+#ifndef WAVE_ADAPTIVE
+#define WAVE_ADAPTIVE 0
+#endif
+
 String buildJsonPayload(
   float lat,
   float lon,
@@ -52,6 +69,45 @@ String buildJsonPayload(
   wave["period"] = sanitize(wavePeriod);
   wave["direction"] = waveDirection;
   wave["power"] = sanitize(wavePower);
+#if WAVE_ADAPTIVE
+  wave["window_s"] = (int)lroundf(getWaveWindowSec());
+#endif
+  float hsCi = getWaveHsCi();
+  if (!isnan(hsCi)) wave["hs_ci"] = round(hsCi * 1000.0f) / 1000.0f;  // ± m, 95%
+  float hsAvg = getWaveHsAvg();
+  if (!isnan(hsAvg)) {
+    // Hs/Tp of the spectrum averaged over recent wakes (rtcState)
+    wave["hs_avg"] = round(hsAvg * 1000.0f) / 1000.0f;
+    wave["tp_avg"] = round(sanitize(getWaveTpAvg()) * 100.0f) / 100.0f;
+    wave["avg_n"] = getWaveAvgCount();
+  }
+#if WAVE_UPLOAD_MOMENTS
+  WaveSpectralParams sp = getWaveSpectralParams();
+  if (sp.tm01 > 0.0f) {
+    wave["tm01"] = round(sp.tm01 * 100.0f) / 100.0f;
+    wave["tm02"] = round(sp.tm02 * 100.0f) / 100.0f;
+    wave["te"] = round(sp.te * 100.0f) / 100.0f;
+    wave["nu"] = round(sp.nu * 100.0f) / 100.0f;
+    wave["eps"] = round(sp.eps * 100.0f) / 100.0f;
+    wave["qp"] = round(sp.qp * 100.0f) / 100.0f;
+  }
+#endif
+  if (getWaveCount() > 0) {
+    // Zero-upcrossing statistics (WAVE_ZERO_CROSSING builds only)
+    wave["hmax"] = round(getWaveHmax() * 1000.0f) / 1000.0f;
+    wave["h13"] = round(getWaveH13() * 1000.0f) / 1000.0f;
+    wave["waves"] = getWaveCount();
+  }
+#if WAVE_UPLOAD_SPECTRUM
+  String spec = getWaveSpectrumBase64();
+  if (spec.length() > 0) wave["spec"] = spec;
+#endif
+  if (waveCollectedConcurrently()) {
+    // Decision data for WAVE_CONCURRENT_MODEM: time saved vs sensor noise added
+    wave["concurrent_saved_s"] = (int)lroundf(getWaveConcurrentSavedSec());
+    float modemNoiseDb = getWaveModemNoiseDb();
+    if (!isnan(modemNoiseDb)) wave["modem_noise_db"] = round(modemNoiseDb * 10.0f) / 10.0f;
+  }
 
   // Buoy diagnostics from IMU
   JsonObject buoy = doc.createNestedObject("buoy");
@@ -81,6 +137,24 @@ String buildJsonPayload(
   JsonObject gps = doc.createNestedObject("gps");
   gps["hdop"] = sanitize(rtcState.lastGpsHdop);
   gps["ttf"] = rtcState.lastGpsTtf;
+  GpsAcqStats acq = getGpsAcqStats();
+  if (acq.outcome != GPS_ACQ_NONE) {
+    // This wake's acquisition: how it ended and the satellite figures behind it
+    gps["acq"] = gpsAcqOutcomeName(acq.outcome);
+    gps["acq_s"] = acq.seconds;
+    gps["sv"] = acq.satsInView;
+    gps["su"] = acq.satsUsed;
+    gps["cn0"] = acq.cn0Max;
+  }
+  GpsXtraStats xtra = getGpsXtraStats();
+  if (xtra.outcome != GPS_XTRA_NONE) {
+    // This wake's XTRA decision, its cost and the estimated saving vs. always downloading
+    gps["xtra"] = gpsXtraOutcomeName(xtra.outcome);
+    gps["xtra_b"] = xtra.bytes;
+    gps["xtra_s"] = xtra.seconds;
+    gps["xtra_saved_b"] = xtra.savedBytes;
+    gps["xtra_saved_s"] = xtra.savedSeconds;
+  }
 
   // Modem/network diagnostics
   JsonObject net = doc.createNestedObject("net");
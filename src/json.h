@@ -3,7 +3,7 @@
 
 //
 // JSON payload construction for API upload.
-// Generates ~700-900 byte JSON document with buoy measurements, diagnostics, alerts.
+// Generates ~700-900 byte JSON document (~1050 with WAVE_UPLOAD_SPECTRUM) with buoy measurements, diagnostics, alerts.
 // Uses ArduinoJson library (StaticJsonDocument<2048>).
 // All float fields sanitized against NaN/Inf (M-12 fix).
 //
@@ -17,13 +17,21 @@
 // Payload structure (major fields):
 //   nodeId, name, version, timestamp (UTC epoch)
 //   lat, lon (WGS84)
-//   wave: height, period, direction, power
+//   wave: height, period, direction, power (+ window_s with WAVE_ADAPTIVE, hs_ci: 95% CI half-width of height, m)
+//         (+ hs_avg, tp_avg, avg_n: Hs/Tp of the spectrum averaged over the last avg_n wakes)
+//         (+ tm01, tm02, te, nu, eps, qp: moment-based periods and shape with WAVE_UPLOAD_MOMENTS)
+//         (+ hmax, h13, waves: zero-upcrossing statistics with WAVE_ZERO_CROSSING)
+//         (+ spec: base64 wave-band spectrum with WAVE_UPLOAD_SPECTRUM, see wave_spectrum.h)
+//         (+ concurrent_saved_s, modem_noise_db when collected concurrently with the modem)
 //   buoy: tilt (degrees from vertical), accel_rms (m/s²)
 //   temp, temp_trend, battery, battery_percent, temp_valid
 //   uptime, boot_count, reset_reason
 //   minutes_to_sleep, next_wake_utc, battery_change_since_last
 //   rtc: waterTemp
-//   gps: hdop, ttf
+//   gps: hdop, ttf (+ acq, acq_s, sv, su, cn0 on wakes that ran GNSS: outcome, seconds,
+//        peak satellites in view, satellites used, peak C/N0 in dB-Hz;
+//        + xtra, xtra_b, xtra_s, xtra_saved_b, xtra_saved_s: XTRA refresh outcome, bytes
+//        and seconds spent, estimated bytes and seconds saved vs. an unconditional download)
 //   net: operator, apn, ip, signal
 //   alerts: anchorDrift, chargingIssue, tempSpike, overTemp, uploadFailed
 //
@@ -35,6 +35,12 @@ extern "C" {
 #define DEBUG_NO_DEEP_SLEEP 0
 #endif
 
+// Default WAVE_CONCURRENT_MODEM to 0: wave collection runs alone with the modem off.
+// 1 = on GPS cycles, collect waves in a task on the other core during modem/GNSS bring-up.
+#ifndef WAVE_CONCURRENT_MODEM
+#define WAVE_CONCURRENT_MODEM 0
+#endif
+
 // Add watchdog include
 #include "esp_task_wdt.h"
 
@@ -617,8 +623,12 @@ void loop() {
   SerialMon.println("\n--- PHASE 2: WAVE DATA COLLECTION ---");
   int phase2BattPct = estimateBatteryPercent(getStableBatteryVoltage());
   bool skipWaves = (phase2BattPct <= 50);
-  SerialMon.printf("Starting wave phase (SoC=%d%%, skipWaves=%s)...\n",
-                   phase2BattPct, skipWaves ? "yes" : "no");
+  // Concurrent collection only pays off on GPS cycles: NTP + XTRA + GNSS usually take
+  // longer than a fixed wave window (160s, 112s with WAVE_GYRO_ATTITUDE), so most or
+  // all of it hides behind them. An adaptive window may run up to WAVE_ADAPTIVE_MAX_S.
+  bool concurrentWaves = WAVE_CONCURRENT_MODEM && shouldGetNewGpsFix && !skipWaves;
+  SerialMon.printf("Starting wave phase (SoC=%d%%, skipWaves=%s, concurrent=%s)...\n",
+                   phase2BattPct, skipWaves ? "yes" : "no", concurrentWaves ? "yes" : "no");
 
   SerialMon.println("  Powering on 3.3V rail (sensors)...");
   // Power on 3.3V rail, wait for stabilization, then power on sensors
@@ -646,8 +656,12 @@ void loop() {
 
   if (skipWaves) {
     SerialMon.printf("  Wave collection skipped (battery %d%% <= 50%%) — temp + upload only\n", phase2BattPct);
+  } else if (concurrentWaves && startWaveCollectionTask()) {
+    SerialMon.println("  Wave collection running concurrently with modem/GNSS (3.3V rail stays on)");
   } else {
-    SerialMon.println("  Collecting wave data (10Hz IMU for 160s)...");
+    concurrentWaves = false;
+    SerialMon.printf("  Collecting wave data (10Hz IMU, up to %lus)...\n",
+                     (unsigned long)getWaveWindowMaxSec());
     esp_task_wdt_reset();
     recordWaveData();
     SerialMon.println("  ✓ Wave data collection complete");
@@ -655,11 +669,15 @@ void loop() {
     logWaveStats();
   }
 
-  SerialMon.println("  Powering down sensors and 3.3V rail...");
-  delay(100);  // brief settle before rail off (no datasheet requirement)
-  powerOff3V3Rail();
-  SerialMon.println("  ✓ Sensors and 3.3V rail powered down");
-  SerialMon.println("✓ PHASE 2 COMPLETE: Wave data collection finished\n");
+  if (!concurrentWaves) {
+    SerialMon.println("  Powering down sensors and 3.3V rail...");
+    delay(100);  // brief settle before rail off (no datasheet requirement)
+    powerOff3V3Rail();
+    SerialMon.println("  ✓ Sensors and 3.3V rail powered down");
+    SerialMon.println("✓ PHASE 2 COMPLETE: Wave data collection finished\n");
+  } else {
+    SerialMon.println("✓ PHASE 2 HANDED OFF: wave task joins after Phase 3\n");
+  }
 
   // 2) Skip pre-GPS HTTP time sync; GPS flow will do NTP + XTRA
   bool networkConnected = false;
@@ -678,13 +696,13 @@ void loop() {
     ensureModemReady();
     SerialMon.println("  ✓ Modem ready");
 
-    SerialMon.println("  Running GNSS acquisition (NTP sync → XTRA download → 60s warmup → fix polling)...");
+    SerialMon.println("  Running GNSS acquisition (NTP sync → XTRA download → 60s warmup → fix search)...");
     fix = getGpsFixDynamic(isFirstFix);
     if (fix.success) {
       SerialMon.printf("  ✓ GPS FIX ACQUIRED: lat=%.6f, lon=%.6f, HDOP=%.1f, TTF=%u seconds\n",
                        fix.latitude, fix.longitude, fix.hdop, fix.ttfSeconds);
       // Always log drift (or no-previous-anchor) before overwriting stored anchor
-      checkAnchorDrift(fix.latitude, fix.longitude);
+      checkAnchorDrift(fix.latitude, fix.longitude, fix.hdop);
       updateLastGpsFix(fix.latitude, fix.longitude, fix.fixTimeEpoch);
       rtcState.lastGpsHdop = fix.hdop;
       rtcState.lastGpsTtf = fix.ttfSeconds;
@@ -816,6 +834,29 @@ void loop() {
     }
   }
 
+  if (concurrentWaves) {
+    SerialMon.println("\n--- PHASE 3b: JOIN CONCURRENT WAVE COLLECTION ---");
+    // Normally already done (GNSS outlasts a fixed window); the timeout is the longest
+    // window + 40s for IMU init and the FIFO timeout
+    if (waitWaveCollectionTask((getWaveWindowMaxSec() + 40) * 1000UL)) {
+      SerialMon.println("  ✓ Wave task joined");
+    } else {
+      SerialMon.println("  ✗ Wave task did not finish — wave data zeroed");
+    }
+    logWaveStats();
+    float modemNoiseDb = getWaveModemNoiseDb();
+    if (isnan(modemNoiseDb)) {
+      SerialMon.printf("  Concurrent waves: saved %.0f s awake; modem noise n/a (no modem-off baseline yet)\n",
+                       getWaveConcurrentSavedSec());
+    } else {
+      SerialMon.printf("  Concurrent waves: saved %.0f s awake; out-of-band noise %+.1f dB vs modem-off\n",
+                       getWaveConcurrentSavedSec(), modemNoiseDb);
+    }
+    SerialMon.println("  Powering down sensors and 3.3V rail...");
+    powerOff3V3Rail();
+    SerialMon.println("  ✓ Sensors and 3.3V rail powered down");
+  }
+
   SerialMon.println("\n--- PHASE 4: TEMPERATURE ANOMALY CHECK ---");
   SerialMon.println("Evaluating water temperature spike/trend detection...");
   checkTemperatureAnomalies();
@@ -13,6 +13,9 @@ RTC_DATA_ATTR rtc_state_t rtcState = {
   .lastGpsFixTime = 0,
   .lastGpsHdop = 99.0f,
   .lastGpsTtf = 0,
+  .gpsTtfHistory = {},
+  .gpsTtfCount = 0,
+  .gpsTtfNext = 0,
   .lastWaterTemp = NAN,
   .tempHistory = {NAN, NAN, NAN, NAN, NAN},
   .tempHistoryCount = 0,
@@ -22,6 +25,10 @@ RTC_DATA_ATTR rtc_state_t rtcState = {
   .anchorDriftDetected = false,
   .anchorDriftCounter = 0,
   .anchorDriftClearCounter = 0,
+  .anchorFixes = {},
+  .anchorFixCount = 0,
+  .anchorFixNext = 0,
+  .anchorDriftFix = {},
   .chargingProblemDetected = false,
   .firmwareUpdateAttempted = false,
   .lastUnsentJson = {0},
@@ -30,26 +37,117 @@ RTC_DATA_ATTR rtc_state_t rtcState = {
   .lastNextWakeUtc = 0,
   .modemFailCount = 0,
   .modemOvervoltageDetected = false,
+  .waveOobBaselineDb = 0.0f,
+  .waveOobBaselineCount = 0,
+  .gyroBias = {0.0f, 0.0f, 0.0f},
+  .gyroBiasValid = 0,
+  .waveSpectrumAvg = {0},
+  .waveSpectrumCount = 0,
+  .waveSpectrumUtc = 0,
 
 };
 
-// Haversine formula to calculate distance in meters between two lat/lon points
-// Uses double-precision internally to avoid precision loss at small angles (<100m)
-static float distanceBetween(float lat1, float lon1, float lat2, float lon2) {
-  const double R = 6371000.0; // Earth radius in meters
-  double dLat = radians((double)(lat2 - lat1));
-  double dLon = radians((double)(lon2 - lon1));
+// Anchor estimate: fixes are weighted by 1/σ² with σ = UERE × HDOP per axis. The ring's
+// scatter beyond the fixes' own noise is the buoy swinging on its mooring, floored at
+// ANCHOR_SWING_M so a few tightly clustered fixes cannot shrink the test ellipse.
+#define ANCHOR_UERE_M        4.0f   // User range error (m, 1σ) behind σ = UERE × HDOP
+#define ANCHOR_SWING_M      10.0f   // Minimum mooring swing (m, 1σ per axis)
+#define ANCHOR_DRIFT_CHI2   13.82f  // χ²(2 dof) at p = 0.001: drift
+#define ANCHOR_BORDER_CHI2   5.99f  // χ²(2 dof) at p = 0.05: borderline from here to 2× drift
+#define ANCHOR_DRIFT_MIN_M  25.0f   // Never report drift below this distance
+#define ANCHOR_DRIFT_MAX_M  50.0f   // Always report drift beyond this distance (the former fixed threshold)
+#define ANCHOR_RELOCATE_COUNT 2     // Consecutive agreeing drifting fixes that restart the estimate there
+
+static void pushAnchorFix(float lat, float lon, float hdop) {
+  if (rtcState.anchorFixNext >= ANCHOR_FIX_HISTORY) rtcState.anchorFixNext = 0;
+  rtcState.anchorFixes[rtcState.anchorFixNext] = {lat, lon, hdop};
+  rtcState.anchorFixNext = (uint8_t)((rtcState.anchorFixNext + 1) % ANCHOR_FIX_HISTORY);
+  if (rtcState.anchorFixCount < ANCHOR_FIX_HISTORY) rtcState.anchorFixCount++;
+}
+
+// Per-axis σ² of a fix; unknown HDOP (99) is clamped so it still counts, just barely
+static double anchorFixVariance(float hdop) {
+  const double h = constrain((double)hdop, 0.8, 20.0) * ANCHOR_UERE_M;
+  return h * h;
+}
+
+// Metres east/north of (lat0, lon0); equirectangular is exact enough over a mooring
+static void anchorProject(double lat0, double lon0, float lat, float lon, double* e, double* n) {
+  const double R = 6371000.0;
+  *e = R * radians((double)lon - lon0) * cos(radians(lat0));
+  *n = R * radians((double)lat - lat0);
+}
+
+bool anchorTest(float lat, float lon, float hdop, float* distM, float* d2) {
+  const uint8_t count = rtcState.anchorFixCount;
+  if (count == 0 || count > ANCHOR_FIX_HISTORY) return false;
+
+  // HDOP-weighted mean and scatter, about the first ring entry
+  const double lat0 = rtcState.anchorFixes[0].lat, lon0 = rtcState.anchorFixes[0].lon;
+  double sw = 0.0, me = 0.0, mn = 0.0;
+  for (uint8_t i = 0; i < count; i++) {
+    const AnchorFix& f = rtcState.anchorFixes[i];
+    double e, n;
+    anchorProject(lat0, lon0, f.lat, f.lon, &e, &n);
+    const double w = 1.0 / anchorFixVariance(f.hdop);
+    sw += w; me += w * e; mn += w * n;
+  }
+  me /= sw; mn /= sw;
+  double cee = 0.0, cen = 0.0, cnn = 0.0;
+  for (uint8_t i = 0; i < count; i++) {
+    const AnchorFix& f = rtcState.anchorFixes[i];
+    double e, n;
+    anchorProject(lat0, lon0, f.lat, f.lon, &e, &n);
+    const double w = 1.0 / anchorFixVariance(f.hdop);
+    cee += w * (e - me) * (e - me);
+    cen += w * (e - me) * (n - mn);
+    cnn += w * (n - mn) * (n - mn);
+  }
+  cee /= sw; cen /= sw; cnn /= sw;
+
+  // Swing = scatter minus the fixes' own noise (harmonic mean of their σ²), floored
+  const double noise = count / sw;
+  const double swingFloor = (double)ANCHOR_SWING_M * ANCHOR_SWING_M;
+  const double see = fmax(cee - noise, swingFloor);
+  const double snn = fmax(cnn - noise, swingFloor);
+  const double sen = constrain(cen, -0.9 * sqrt(see * snn), 0.9 * sqrt(see * snn));
+
+  // Innovation covariance: swing of the new fix and of the mean, the mean's noise, the fix's noise
+  const double k = 1.0 + 1.0 / count;
+  const double fixVar = anchorFixVariance(hdop);
+  const double Se = k * see + 1.0 / sw + fixVar;
+  const double Sn = k * snn + 1.0 / sw + fixVar;
+  const double Sc = k * sen;
+
+  double e, n;
+  anchorProject(lat0, lon0, lat, lon, &e, &n);
+  e -= me; n -= mn;
+  *distM = (float)sqrt(e * e + n * n);
+  *d2 = (float)((e * e * Sn - 2.0 * e * n * Sc + n * n * Se) / (Se * Sn - Sc * Sc));
+  return true;
+}
 
-  double a = sin(dLat / 2.0) * sin(dLat / 2.0) +
-            cos(radians((double)lat1)) * cos(radians((double)lat2)) *
-            sin(dLon / 2.0) * sin(dLon / 2.0);
-  double c = 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
-  double distance = R * c;
+static bool anchorDrifted(float dist, float d2) {
+  return dist > ANCHOR_DRIFT_MAX_M || (d2 > ANCHOR_DRIFT_CHI2 && dist > ANCHOR_DRIFT_MIN_M);
+}
 
-  return (float)distance;  // Cast back to float for storage
+bool anchorTestBorderline(float lat, float lon, float hdop) {
+  float dist, d2;
+  if (!anchorTest(lat, lon, hdop, &dist, &d2)) return false;
+  if (dist > 0.5f * ANCHOR_DRIFT_MAX_M && dist < 2.0f * ANCHOR_DRIFT_MAX_M) return true;
+  return d2 > ANCHOR_BORDER_CHI2 && d2 < 2.0f * ANCHOR_DRIFT_CHI2 && dist > 0.5f * ANCHOR_DRIFT_MIN_M;
 }
 
-#define ANCHOR_DRIFT_DISTANCE_THRESHOLD 50.0f
+// Two drifting fixes agree if they are the same mooring: their difference is within
+// both fixes' noise plus twice the swing floor (χ²(2) at p = 0.05)
+static bool anchorFixesAgree(const AnchorFix& a, float lat, float lon, float hdop, float* distM) {
+  double e, n;
+  anchorProject(a.lat, a.lon, lat, lon, &e, &n);
+  *distM = (float)sqrt(e * e + n * n);
+  const double var = anchorFixVariance(a.hdop) + anchorFixVariance(hdop) +
+                     2.0 * (double)ANCHOR_SWING_M * ANCHOR_SWING_M;
+  return (e * e + n * n) / var <= ANCHOR_BORDER_CHI2;
+}
 
 void rtcStateBegin() {
   // Restore state from NVS if this boot follows a hard reset (OTA, brownout).
@@ -80,9 +178,11 @@ void logRtcState() {
   SerialMon.printf("- Battery voltage: %.2f V\n", rtcState.lastBatteryVoltage);
   SerialMon.printf("- Last GPS fix: %.6f, %.6f\n", rtcState.lastGpsLat, rtcState.lastGpsLon);
   SerialMon.printf("- Last GPS fix time: %lu\n", rtcState.lastGpsFixTime);
+  SerialMon.printf("- GPS TTF history: %d acquisitions\n", rtcState.gpsTtfCount);
   SerialMon.printf("- Last water temp: %.2f C\n", rtcState.lastWaterTemp);
   SerialMon.printf("- Anchor drift detected: %s\n", rtcState.anchorDriftDetected ? "YES" : "NO");
   SerialMon.printf("- Anchor drift counter: %d\n", rtcState.anchorDriftCounter);
+  SerialMon.printf("- Anchor estimate: %d fixes\n", rtcState.anchorFixCount);
   SerialMon.printf("- Charging problem: %s\n", rtcState.chargingProblemDetected ? "YES" : "NO");
   SerialMon.printf("- Temp spike detected: %s\n", rtcState.tempSpikeDetected ? "YES" : "NO");
   SerialMon.printf("- Over temp detected: %s\n", rtcState.overTempDetected ? "YES" : "NO");
@@ -90,6 +190,13 @@ void logRtcState() {
   SerialMon.printf("- FW update attempted: %s\n", rtcState.firmwareUpdateAttempted ? "YES" : "NO");
   SerialMon.printf("- Modem fail count: %d\n", rtcState.modemFailCount);
   SerialMon.printf("- Modem overvoltage: %s\n", rtcState.modemOvervoltageDetected ? "YES" : "NO");
+  SerialMon.printf("- Wave OOB baseline: %.1f dB (%d cycles)\n",
+                   rtcState.waveOobBaselineDb, rtcState.waveOobBaselineCount);
+  SerialMon.printf("- Wave spectrum average: %d wakes\n", rtcState.waveSpectrumCount);
+  if (rtcState.gyroBiasValid) {
+    SerialMon.printf("- Gyro bias: %.2f %.2f %.2f dps\n", rtcState.gyroBias[0] * 57.2958f,
+                     rtcState.gyroBias[1] * 57.2958f, rtcState.gyroBias[2] * 57.2958f);
+  }
 }
 
 void updateLastGpsFix(float lat, float lon, uint32_t epochSec) {
@@ -100,21 +207,46 @@ void updateLastGpsFix(float lat, float lon, uint32_t epochSec) {
   // drift state must accumulate across boots for reliable detection.
 }
 
-void checkAnchorDrift(float currentLat, float currentLon) {
+void checkAnchorDrift(float currentLat, float currentLon, float hdop) {
+  // Firmware without the anchor ring only kept the last fix: start the estimate from it
+  if (rtcState.anchorFixCount == 0 && rtcState.lastGpsFixTime > 1000000000) {
+    pushAnchorFix(rtcState.lastGpsLat, rtcState.lastGpsLon, rtcState.lastGpsHdop);
+  }
+  float dist, d2;
   // If we don't have a previous anchor stored, inform and return
-  if (rtcState.lastGpsFixTime <= 1000000000) {
+  if (!anchorTest(currentLat, currentLon, hdop, &dist, &d2)) {
     SerialMon.println("Anchor drift check: No previous anchor");
     rtcState.anchorDriftDetected = false;
     rtcState.anchorDriftCounter = 0;
+    pushAnchorFix(currentLat, currentLon, hdop);
     return;
   }
-  float dist = distanceBetween(currentLat, currentLon, rtcState.lastGpsLat, rtcState.lastGpsLon);
-  if (dist > ANCHOR_DRIFT_DISTANCE_THRESHOLD) {
+  if (anchorDrifted(dist, d2)) {
     if (rtcState.anchorDriftCounter < 255) rtcState.anchorDriftCounter++;
     rtcState.anchorDriftDetected = true;
     rtcState.anchorDriftClearCounter = 0;  // reset any clear streak
+    // Drifting fixes stay out of the estimate, unless they repeat at one spot: then the
+    // buoy has moved, and the alert clears once it stays put there. Drifting fixes that
+    // disagree mean it is still moving, so the estimate is kept.
+    float apart = 0.0f;
+    if (rtcState.anchorDriftCounter >= ANCHOR_RELOCATE_COUNT &&
+        anchorFixesAgree(rtcState.anchorDriftFix, currentLat, currentLon, hdop, &apart)) {
+      rtcState.anchorFixCount = 0;
+      rtcState.anchorFixNext = 0;
+      pushAnchorFix(rtcState.anchorDriftFix.lat, rtcState.anchorDriftFix.lon, rtcState.anchorDriftFix.hdop);
+      pushAnchorFix(currentLat, currentLon, hdop);
+      SerialMon.printf("Anchor estimate restarted at %.6f, %.6f (drifting fixes %.1f m apart)\n",
+                       currentLat, currentLon, apart);
+    } else {
+      if (rtcState.anchorDriftCounter >= ANCHOR_RELOCATE_COUNT) {
+        SerialMon.printf("Drifting fixes %.1f m apart: still moving, anchor estimate kept\n", apart);
+      }
+      rtcState.anchorDriftFix = {currentLat, currentLon, hdop};
+    }
   } else {
     rtcState.anchorDriftCounter = 0;
+    // Borderline fixes are not folded in, so a slow creep cannot drag the anchor along
+    if (d2 <= ANCHOR_BORDER_CHI2) pushAnchorFix(currentLat, currentLon, hdop);
     if (rtcState.anchorDriftDetected) {
       // Require 2 consecutive clear readings before resolving the alert
       if (rtcState.anchorDriftClearCounter < 255) rtcState.anchorDriftClearCounter++;
@@ -131,11 +263,20 @@ void checkAnchorDrift(float currentLat, float currentLon) {
     }
   }
 
-  SerialMon.printf("Anchor drift check: distance=%.2f m, driftCounter=%d, clearCounter=%d, alert=%s\n",
-                   dist, rtcState.anchorDriftCounter, rtcState.anchorDriftClearCounter,
+  SerialMon.printf("Anchor drift check: distance=%.2f m, D²=%.1f (drift >%.1f), HDOP=%.1f, "
+                   "fixes=%d, driftCounter=%d, clearCounter=%d, alert=%s\n",
+                   dist, d2, ANCHOR_DRIFT_CHI2, hdop, rtcState.anchorFixCount,
+                   rtcState.anchorDriftCounter, rtcState.anchorDriftClearCounter,
                    rtcState.anchorDriftDetected ? "YES" : "NO");
 }
 
+void pushGpsTtfSample(const GpsTtfSample& sample) {
+  if (rtcState.gpsTtfNext >= GPS_TTF_HISTORY) rtcState.gpsTtfNext = 0;
+  rtcState.gpsTtfHistory[rtcState.gpsTtfNext] = sample;
+  rtcState.gpsTtfNext = (uint8_t)((rtcState.gpsTtfNext + 1) % GPS_TTF_HISTORY);
+  if (rtcState.gpsTtfCount < GPS_TTF_HISTORY) rtcState.gpsTtfCount++;
+}
+
 void pushTemperatureHistory(float temp) {
   if (isnan(temp)) return;
   // Shift history: oldest falls off [0], newest goes to end
@@ -277,12 +418,19 @@ void saveStateToNvs() {
   prefs.putULong("gpsFix",     rtcState.lastGpsFixTime);
   prefs.putFloat("gpsHdop",    rtcState.lastGpsHdop);
   prefs.putUShort("gpsTtf",    rtcState.lastGpsTtf);
+  prefs.putUChar("ttfCnt",     rtcState.gpsTtfCount);
+  prefs.putUChar("ttfNext",    rtcState.gpsTtfNext);
+  prefs.putBytes("ttfHist",    rtcState.gpsTtfHistory, sizeof(rtcState.gpsTtfHistory));
   prefs.putFloat("wTemp",      rtcState.lastWaterTemp);
   prefs.putUChar("thCnt",      rtcState.tempHistoryCount);
   prefs.putBytes("tHist",      rtcState.tempHistory, sizeof(rtcState.tempHistory));
   prefs.putUChar("driftCnt",   rtcState.anchorDriftCounter);
   prefs.putBool("driftDet",    rtcState.anchorDriftDetected);
   prefs.putUChar("driftClr",   rtcState.anchorDriftClearCounter);
+  prefs.putUChar("ancCnt",     rtcState.anchorFixCount);
+  prefs.putUChar("ancNext",    rtcState.anchorFixNext);
+  prefs.putBytes("ancFix",     rtcState.anchorFixes, sizeof(rtcState.anchorFixes));
+  prefs.putBytes("ancDrift",   &rtcState.anchorDriftFix, sizeof(rtcState.anchorDriftFix));
   prefs.putBool("chgProb",     rtcState.chargingProblemDetected);
   prefs.putBool("otaPend",     true);  // flag: restore needed on next boot
 
@@ -318,12 +466,28 @@ bool restoreStateFromNvs() {
   rtcState.lastGpsFixTime        = prefs.getULong("gpsFix", 0);
   rtcState.lastGpsHdop           = prefs.getFloat("gpsHdop", 99.0f);
   rtcState.lastGpsTtf            = prefs.getUShort("gpsTtf", 0);
+  rtcState.gpsTtfCount           = prefs.getUChar("ttfCnt", 0);
+  rtcState.gpsTtfNext            = prefs.getUChar("ttfNext", 0);
+  if (prefs.getBytes("ttfHist", rtcState.gpsTtfHistory, sizeof(rtcState.gpsTtfHistory)) !=
+      sizeof(rtcState.gpsTtfHistory)) {
+    rtcState.gpsTtfCount = 0;  // Snapshot from older firmware or a different ring size
+  }
   rtcState.lastWaterTemp         = prefs.getFloat("wTemp", NAN);
   rtcState.tempHistoryCount      = prefs.getUChar("thCnt", 0);
   prefs.getBytes("tHist", rtcState.tempHistory, sizeof(rtcState.tempHistory));
   rtcState.anchorDriftCounter      = prefs.getUChar("driftCnt", 0);
   rtcState.anchorDriftDetected     = prefs.getBool("driftDet", false);
   rtcState.anchorDriftClearCounter = prefs.getUChar("driftClr", 0);
+  rtcState.anchorFixCount          = prefs.getUChar("ancCnt", 0);
+  rtcState.anchorFixNext           = prefs.getUChar("ancNext", 0);
+  if (prefs.getBytes("ancFix", rtcState.anchorFixes, sizeof(rtcState.anchorFixes)) !=
+      sizeof(rtcState.anchorFixes)) {
+    rtcState.anchorFixCount = 0;  // Older firmware: reseeded from the last fix on the next check
+  }
+  if (prefs.getBytes("ancDrift", &rtcState.anchorDriftFix, sizeof(rtcState.anchorDriftFix)) !=
+      sizeof(rtcState.anchorDriftFix)) {
+    rtcState.anchorDriftFix = {0.0f, 0.0f, 99.0f};  // Older firmware: the next drifting fix starts over
+  }
   rtcState.chargingProblemDetected = prefs.getBool("chgProb", false);
   rtcState.firmwareUpdateAttempted = true;  // we know we got here via OTA
 
@@ -334,6 +498,14 @@ bool restoreStateFromNvs() {
   if (rtcState.lastGpsLat < -90.0f || rtcState.lastGpsLat > 90.0f) validRestore = false;  // Invalid latitude
   if (rtcState.lastGpsLon < -180.0f || rtcState.lastGpsLon > 180.0f) validRestore = false;  // Invalid longitude
   if (rtcState.lastGpsFixTime > 0 && rtcState.lastGpsFixTime < 1000000000) validRestore = false;  // Before year 2001
+  if (rtcState.gpsTtfCount > GPS_TTF_HISTORY || rtcState.gpsTtfNext >= GPS_TTF_HISTORY) {
+    rtcState.gpsTtfCount = 0;  // Corrupt ring: drop the history, keep the rest
+    rtcState.gpsTtfNext = 0;
+  }
+  if (rtcState.anchorFixCount > ANCHOR_FIX_HISTORY || rtcState.anchorFixNext >= ANCHOR_FIX_HISTORY) {
+    rtcState.anchorFixCount = 0;
+    rtcState.anchorFixNext = 0;
+  }
 
   if (!validRestore) {
     SerialMon.println("NVS: restored data validation FAILED — treating as cold boot");
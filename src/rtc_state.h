@@ -1,6 +1,27 @@
 #pragma once
 
 #include <Arduino.h>
+#include "wave_spectrum.h"
+
+static constexpr uint8_t GPS_TTF_HISTORY = 16;  // GNSS acquisitions kept for the learned timeout
+
+// One GNSS acquisition, for the learned fix timeout (gps.cpp)
+typedef struct {
+  uint16_t seconds;      // Acquisition start → accepted fix, or → timeout if none
+  uint8_t startMode;     // 0 = hot, 1 = warm, 2 = cold
+  uint8_t xtraAgeDays;   // Age of the XTRA file at start (255 = none/unknown)
+  uint8_t hdopX10;       // HDOP of the accepted fix ×10, saturating (255 = no fix)
+  uint8_t outcome;       // GpsAcqOutcome (gps.h) that ended it; 0 = older firmware, judged by HDOP
+} GpsTtfSample;
+
+static constexpr uint8_t ANCHOR_FIX_HISTORY = 8;  // GNSS fixes kept for the anchor position estimate
+
+// One GNSS fix that agreed with the anchor estimate, or the last drifting one (checkAnchorDrift)
+typedef struct {
+  float lat;
+  float lon;
+  float hdop;            // Weights the fix in the estimate (σ ≈ UERE × HDOP)
+} AnchorFix;
 
 //
 // Persistent state stored in RTC memory, survives deep sleep cycles.
@@ -19,6 +40,9 @@ typedef struct {
   uint32_t lastGpsFixTime;           // Unix epoch timestamp of last GPS fix
   float lastGpsHdop;                 // HDOP from last fix (lower = better)
   uint16_t lastGpsTtf;              // Time-to-fix in seconds
+  GpsTtfSample gpsTtfHistory[GPS_TTF_HISTORY]; // Ring of recent acquisitions (learned timeout)
+  uint8_t gpsTtfCount;              // Valid entries in gpsTtfHistory (0-GPS_TTF_HISTORY)
+  uint8_t gpsTtfNext;               // Ring index of the next entry to write
 
   // Water temperature monitoring
   float lastWaterTemp;               // Last recorded water temperature
@@ -34,6 +58,10 @@ typedef struct {
   bool anchorDriftDetected;          // Flag for confirmed anchor drift alert
   uint8_t anchorDriftCounter;        // Counter for consecutive drift detections
   uint8_t anchorDriftClearCounter;   // Consecutive clear readings; cleared when drift resolves (≥2 = resolved)
+  AnchorFix anchorFixes[ANCHOR_FIX_HISTORY]; // Ring of fixes the anchor estimate is built from
+  uint8_t anchorFixCount;            // Valid entries in anchorFixes (0-ANCHOR_FIX_HISTORY)
+  uint8_t anchorFixNext;             // Ring index of the next entry to write
+  AnchorFix anchorDriftFix;          // Last drifting fix; relocation needs the next one to agree with it
 
   // Battery charging alert
   bool chargingProblemDetected;      // Flag if no charge detected over 24 hours
@@ -42,7 +70,7 @@ typedef struct {
   bool firmwareUpdateAttempted;      // Set before OTA restart, cleared on successful boot
 
   // Data buffering for failed uploads
-  char lastUnsentJson[1024];        // Buffer for last unsent JSON payload (typical payload ~700-900 bytes)
+  char lastUnsentJson[1280];        // Buffer for last unsent JSON payload (typical payload ~700-900 bytes, ~1050 with wave.spec)
   bool hasUnsentData;               // Flag if there is unsent data
 
   // Sleep planning snapshot (for wake reason context)
@@ -53,6 +81,19 @@ typedef struct {
   uint8_t modemFailCount;           // Consecutive wake cycles that failed to establish network
   bool modemOvervoltageDetected;    // Set when OVER-VOLTAGE URC received; cleared on successful cycle
 
+  // Wave sensor noise floor with the modem off (baseline for concurrent wave collection)
+  float waveOobBaselineDb;          // EWMA of out-of-band (2-4.5Hz) heave PSD, dB re (m/s²)²/Hz
+  uint8_t waveOobBaselineCount;     // Cycles folded into the baseline (0 = no baseline yet, saturates at 255)
+
+  // Gyro bias learned over previous wave windows (WAVE_GYRO_ATTITUDE)
+  float gyroBias[3];                // rad/s, body X/Y/Z
+  uint8_t gyroBiasValid;            // 0 = not learned yet
+
+  // Wave spectrum averaged over recent wakes (wave_spectrum.h; EWMA in linear power)
+  uint8_t waveSpectrumAvg[WAVE_SPECTRUM_BINS]; // Log-quantised displacement PSD over the wave band
+  uint8_t waveSpectrumCount;        // Wakes folded in (0 = empty, saturates at 255)
+  uint32_t waveSpectrumUtc;         // Epoch of the last update (0 = time was unknown)
+
 } rtc_state_t;
 
 //
@@ -70,7 +111,13 @@ void logRtcState();                 // Logs the full rtcState struct to Serial
 // GPS and anchor drift management
 //
 void updateLastGpsFix(float lat, float lon, uint32_t epochSec);
-void checkAnchorDrift(float currentLat, float currentLon);
+void checkAnchorDrift(float currentLat, float currentLon, float hdop);
+// Test a fix against the HDOP-weighted anchor estimate without changing state.
+// distM is the distance to the estimate, d2 the squared Mahalanobis distance under
+// the combined uncertainty. Returns false when there is no anchor yet.
+bool anchorTest(float lat, float lon, float hdop, float* distM, float* d2);
+bool anchorTestBorderline(float lat, float lon, float hdop);  // Close to the drift threshold — worth more fixes
+void pushGpsTtfSample(const GpsTtfSample& sample);  // Add an acquisition to the TTF ring
 
 //
 // Temperature monitoring
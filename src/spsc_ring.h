@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+//
+// Lock-free single-producer / single-consumer ring buffer.
+// Pure C++ (no Arduino/FreeRTOS dependency).
+//
+// Exactly one task may call push() and exactly one (other) task may call pop().
+// head is written only by the producer, tail only by the consumer; each side
+// publishes its index with release ordering and reads the other's with acquire,
+// so an element is fully written before the consumer can see it.
+//
+// N must be a power of 2. Indices run freely and wrap at 2^32, so the ring holds
+// up to N elements (no wasted slot).
+//
+template <typename T, uint32_t N>
+class SpscRing {
+ public:
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of 2");
+
+  // Producer side. Returns false (element dropped) if the ring is full.
+  bool push(const T& item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= N) return false;
+    buf_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the ring is empty.
+  bool pop(T& out) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail) return false;
+    out = buf_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate fill level (exact when called from either side with the other idle)
+  uint32_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  static constexpr uint32_t capacity() { return N; }
+
+  // Only while neither side is active
+  void reset() {
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  T buf_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
@@ -4,41 +4,269 @@
 //
 // This eliminates drift from double integration and the empirical DISP_AMP_SCALE
 // fudge factor. Spectral Hs = 4*sqrt(m0) is the standard oceanographic method.
+//
+// The spectrum is a streaming Welch estimate: each 50%-overlapped segment is
+// windowed and FFT'd as soon as it fills during sampling, and its PSD is added
+// to a running half-spectrum. No full-record sample buffer is kept.
+//
+// The Welch estimator and spectral integration live in WaveAnalyzer
+// (wave_analyzer.h, no Arduino dependency); this file is the sensor side: IMU,
+// gravity removal, band-limiting, settling, gating and reporting.
+// WAVE_ENGINE=2 swaps in ArWaveAnalyzer (ar_analyzer.h): a Burg AR model of one
+// shorter record instead of the Welch average.
+// The vector kernels (mean removal, window, FFT, band integration) go through
+// dsp.h, which uses esp-dsp on target and portable loops elsewhere.
 
 #include "wave.h"
 #include "sensors.h"
 #include "config.h"
+#include "fft.h"
+#include "dsp.h"
+#include "rtc_state.h"
+#include "spsc_ring.h"
+#include "biquad.h"
+#include "decimator.h"
+#include "wave_analyzer.h"
+#include "ar_analyzer.h"
+#include "wave_spectrum.h"
+#include "utils.h"
 #include "esp_task_wdt.h"
+#include "esp_sleep.h"
 #include <Wire.h>
 #include <math.h>
 #include <algorithm>
+#include <time.h>
+#include <atomic>
 
 #define SerialMon Serial
 
 // Sampling configuration
-static const float FS_HZ = 10.0f;           // IMU sample rate
+static constexpr float FS_HZ = 10.0f;       // Analysis sample rate
 static const uint32_t DT_MS = (uint32_t)(1000.0f / FS_HZ);
 
-// Band limits for heave acceleration pre-filtering
-// HP cutoff set BELOW WAVE_FREQ_MIN (0.05Hz) so the lowest wave bins
-// see full power; a first-order HP at its own cutoff attenuates by -3dB.
-static const float HP_CUTOFF_HZ = 0.03f;    // -1.3dB at 0.05Hz (was 0.05Hz → -3dB)
-static const float LP_CUTOFF_HZ = 2.0f;     // Allow higher frequencies into FFT
+// Oversampling: 1 = the IMU outputs FS_HZ directly; R > 1 = the IMU runs at R·FS_HZ
+// with a DLPF below that rate's Nyquist, and a polyphase FIR (decimator.h) brings
+// every channel down to FS_HZ before any processing, so 5-44Hz vibration can no
+// longer alias into the wave band. Only decimated frames are stored.
+#ifndef WAVE_DECIMATE
+#define WAVE_DECIMATE 1
+#endif
+static_assert(WAVE_DECIMATE >= 1 && WAVE_DECIMATE <= 10 && 100 % WAVE_DECIMATE == 0,
+              "WAVE_DECIMATE must be 1, 2, 4, 5 or 10 (IMU rate 10-100 Hz from the 1 kHz base)");
+static constexpr float IMU_RATE_HZ = FS_HZ * WAVE_DECIMATE;
+static const uint32_t IMU_DT_MS = DT_MS / WAVE_DECIMATE;
+static const uint8_t IMU_SMPLRT_DIV = (uint8_t)(1000 / (10 * WAVE_DECIMATE) - 1);  // 1 kHz / (1 + div)
+
+// Band limits for heave acceleration pre-filtering (Butterworth SOS, biquad.h).
+// HP cutoff set BELOW WAVE_FREQ_MIN (0.05Hz) so the lowest wave bins see nearly
+// full power; the 2nd-order HP is -0.5dB at 0.05Hz and falls 12dB/octave below.
+// The 4th-order LP is flat to <0.01dB at 1Hz.
+#ifndef WAVE_HP_CUTOFF_HZ
+#define WAVE_HP_CUTOFF_HZ 0.03f
+#endif
+#ifndef WAVE_LP_CUTOFF_HZ
+#define WAVE_LP_CUTOFF_HZ 2.0f
+#endif
+static const uint32_t HP_SECTIONS = 1;      // order 2
+static const uint32_t LP_SECTIONS = 2;      // order 4
 
 // Gravity tracker low-pass frequency
-static const float G_TRACK_FC_HZ = 0.02f;   // very slow gravity tracker
+static constexpr float G_TRACK_FC_HZ = 0.02f;   // very slow gravity tracker
+
+// Heave band-limiting: 0 = bandLimit() Butterworth band-pass per sample; 1 = no time-domain
+// filter — the band is cut exactly by the spectral bin range and the gravity
+// tracker's own high-pass response is divided out of the spectral weights, so only
+// the tracker's start-up has to be skipped.
+#ifndef WAVE_BANDLIMIT_SPECTRAL
+#define WAVE_BANDLIMIT_SPECTRAL 0
+#endif
+
+// Gravity estimate: 0 = accel-only low-pass tracker (needs ~57s to settle);
+// 1 = gyro-aided complementary filter, aligned from the first 2s of accel.
+// The gyro is powered anyway (PWR_MGMT_2 defaults to all axes on).
+#ifndef WAVE_GYRO_ATTITUDE
+#define WAVE_GYRO_ATTITUDE 0
+#endif
 
-// FFT configuration
-static const uint32_t FFT_N = 1024;          // Power of 2, ~102.4s at 10 Hz
+// Welch configuration: FFT_N-point segments, 50% overlap, periodic Hann window.
+// 512 points = 51.2s per segment, df = 0.0195 Hz. After the gravity estimate has
+// settled, the remaining 1024 samples yield 3 overlapping segments.
+static constexpr uint32_t FFT_N = 512;       // Segment length (power of 2)
+static const uint32_t WELCH_HOP = FFT_N / 2; // New samples per segment (50% overlap)
+#if WAVE_GYRO_ATTITUDE && WAVE_BANDLIMIT_SPECTRAL
+// No HP filter hides the gyro bias loop converging: a cold start (no learned bias
+// in rtcState) waits as long as the accel-only tracker, a warm one only for alignment
+static const uint32_t SETTLE_SAMPLES = 576;
+static const uint32_t SETTLE_SAMPLES_WARM = 40;
+#elif WAVE_GYRO_ATTITUDE
+static const uint32_t SETTLE_SAMPLES = 100;  // 2s alignment + ~1.5 HP time constants, not analysed
+#else
+static const uint32_t SETTLE_SAMPLES = 576;  // ~57.6s gravity tracker settling, not analysed
+#endif
 
 // Wave band limits for spectral integration
-static const float WAVE_FREQ_MIN = 0.05f;    // Min wave frequency (20s period)
-static const float WAVE_FREQ_MAX = 1.0f;     // Max wave frequency (1s period)
+static constexpr float WAVE_FREQ_MIN = 0.05f;    // Min wave frequency (20s period)
+static constexpr float WAVE_FREQ_MAX = 1.0f;     // Max wave frequency (1s period)
 
 #ifndef WAVE_TP_MAX_S
 #define WAVE_TP_MAX_S 8.0f
 #endif
 
+// Spectral engine.
+// 0 = streaming Welch: int16 heave history, real FFT per segment, full 0-5Hz PSD.
+// 1 = DFT bank: running DFT of only the wave-band bins, updated on every sample.
+//     No FFT and no sample history, but no out-of-band noise metric either.
+// 2 = Burg AR: keeps the whole record (WAVE_AR_SAMPLES floats ×2) and fits an
+//     AR(WAVE_AR_ORDER) model after sampling. Stable Tp from ~45s instead of 102s,
+//     but no out-of-band noise metric and no Hs CI (so no WAVE_ADAPTIVE).
+#define WAVE_ENGINE_FFT 0
+#define WAVE_ENGINE_DFTBANK 1
+#define WAVE_ENGINE_BURG 2
+#ifndef WAVE_ENGINE
+#define WAVE_ENGINE WAVE_ENGINE_FFT
+#endif
+
+#ifndef WAVE_AR_ORDER
+#define WAVE_AR_ORDER 24
+#endif
+// Analysed samples after settling; 500 with WAVE_GYRO_ATTITUDE gives a 60s window
+#ifndef WAVE_AR_SAMPLES
+#define WAVE_AR_SAMPLES (2 * FFT_N)
+#endif
+#if WAVE_ENGINE == WAVE_ENGINE_BURG
+static const uint32_t ANALYSIS_SAMPLES = WAVE_AR_SAMPLES;
+#else
+static const uint32_t ANALYSIS_SAMPLES = 2 * FFT_N;   // 3 Welch segments
+#endif
+
+// Tp zoom: points per bin of the direct DTFT evaluated around the spectral peak
+// (±2 bins, every segment) to find Tp without the 3-bin parabola's bias.
+// 0 = parabola only. Opt-in for swell-dominated sites: it sharpens narrow peaks,
+// but on wind-sea spectra Tp scatter is set by the segment count, not the grid.
+// FFT engine only (needs the heave history).
+#ifndef WAVE_TP_ZOOM
+#define WAVE_TP_ZOOM 0
+#endif
+
+// Individual waves: each Welch segment's spectrum is turned into displacement and
+// inverse-FFT'd in place; zero-upcrossings of the result give Hmax, H1/3 and the
+// wave count (logged and uploaded). FFT engine only; +256 B and one inverse FFT
+// per segment.
+#ifndef WAVE_ZERO_CROSSING
+#define WAVE_ZERO_CROSSING 0
+#endif
+#if WAVE_ZERO_CROSSING
+static_assert(WAVE_ENGINE == WAVE_ENGINE_FFT, "WAVE_ZERO_CROSSING needs the FFT engine");
+#endif
+
+// Once per boot, run both FFT backends on a test signal and log agreement + speedup
+// (only meaningful when esp-dsp is the active backend). Off by default: it needs a
+// 2KB stack buffer in the wave task, and tools/wave_bench (dsp) checks the same
+// agreement on a host. Turn it on to measure target cycles.
+#ifndef WAVE_DSP_SELFTEST
+#define WAVE_DSP_SELFTEST 0
+#endif
+
+#if WAVE_DSP_ESPDSP && WAVE_DSP_SELFTEST && WAVE_ENGINE == WAVE_ENGINE_FFT
+#include "esp_timer.h"
+#endif
+
+// Acquisition mode: 1 = MPU6500 hardware FIFO, drained in bursts every WAVE_FIFO_DRAIN_MS
+// with the CPU in light sleep in between; sample timing comes from the IMU clock.
+// 0 (or FIFO init failure) = poll one sample per 100ms tick.
+#ifndef WAVE_USE_FIFO
+#define WAVE_USE_FIFO 1
+#endif
+
+#ifndef WAVE_FIFO_DRAIN_MS
+#if WAVE_GYRO_ATTITUDE
+#define WAVE_FIFO_DRAIN_MS (2000 / WAVE_DECIMATE)   // 12-byte frames fill the FIFO twice as fast
+#else
+#define WAVE_FIFO_DRAIN_MS (4000 / WAVE_DECIMATE)
+#endif
+#endif
+
+#ifndef WAVE_FIFO_LIGHT_SLEEP
+#define WAVE_FIFO_LIGHT_SLEEP 1
+#endif
+
+// Adaptive window: at every Welch hop after settling, stop early if the sea is
+// clearly calm or the 95% CI of Hs (from the spread of per-segment m0) is within
+// WAVE_ADAPTIVE_CI_REL of Hs or WAVE_ADAPTIVE_CI_ABS_M; otherwise keep sampling up
+// to WAVE_ADAPTIVE_MAX_S. 0 = fixed 160s window.
+#ifndef WAVE_ADAPTIVE
+#define WAVE_ADAPTIVE 0
+#endif
+
+#ifndef WAVE_ADAPTIVE_MAX_S
+#define WAVE_ADAPTIVE_MAX_S 240
+#endif
+
+#ifndef WAVE_ADAPTIVE_CI_REL
+#define WAVE_ADAPTIVE_CI_REL 0.10f
+#endif
+
+#ifndef WAVE_ADAPTIVE_CI_ABS_M
+#define WAVE_ADAPTIVE_CI_ABS_M 0.02f
+#endif
+
+// Concurrent collection task (see startWaveCollectionTask). The Arduino loop task
+// runs on core 1; the wave task takes core 0 at a higher priority.
+#ifndef WAVE_TASK_CORE
+#define WAVE_TASK_CORE 0
+#endif
+
+#ifndef WAVE_TASK_PRIORITY
+#define WAVE_TASK_PRIORITY 5
+#endif
+
+#if WAVE_DSP_ESPDSP && WAVE_DSP_SELFTEST && WAVE_ENGINE == WAVE_ENGINE_FFT
+#define WAVE_TASK_STACK 6144             // dspCrossCheck() needs a 2KB stack buffer
+#else
+#define WAVE_TASK_STACK 4096
+#endif
+
+// IMU producer task: only reads the sensor and pushes raw counts into the ring.
+// Highest wave priority so processing on the consumer side never delays a read.
+// -1 = the core the consumer is not on: core 0 when the loop task consumes, core 1
+// under the concurrent wave task (there it preempts the loop task's modem/GNSS
+// work, which mostly waits on the UART, for a few ms per drain).
+#ifndef WAVE_IMU_CORE
+#define WAVE_IMU_CORE -1
+#endif
+
+#ifndef WAVE_IMU_TASK_PRIORITY
+#define WAVE_IMU_TASK_PRIORITY 10
+#endif
+
+#define WAVE_IMU_TASK_STACK 3072
+
+// Keep every raw IMU frame of the window (3 × int16 accel, 9.6KB; ×2 with gyro) and
+// print it as CSV from logWaveStats() for host replay (tools/wave_replay).
+// Diagnostics builds only.
+#ifndef WAVE_RAW_CAPTURE
+#define WAVE_RAW_CAPTURE 0
+#endif
+
+// Out-of-band band for the modem noise check: above the wave band and the LP
+// corner, where real heave has negligible energy and supply/TX noise shows up.
+// The LP stopband attenuates it by 3-50dB, equally in the baseline and the
+// concurrent cycle, so the difference in dB is unaffected.
+static const float OOB_FREQ_MIN = 2.0f;
+static const float OOB_FREQ_MAX = 4.5f;
+static const float OOB_BASELINE_ALPHA = 0.25f;  // EWMA weight of a new modem-off cycle
+
+// Spectrum average across wakes (rtcState.waveSpectrumAvg, wave_spectrum.h): each
+// wake's displacement PSD is resampled onto WAVE_SPECTRUM_BINS bins over the wave
+// band and folded in with weight WAVE_SPECTRUM_ALPHA (0.25 ≈ the last 7 wakes).
+// A gap longer than WAVE_SPECTRUM_MAX_AGE_S restarts the average.
+#ifndef WAVE_SPECTRUM_ALPHA
+#define WAVE_SPECTRUM_ALPHA 0.25f
+#endif
+#ifndef WAVE_SPECTRUM_MAX_AGE_S
+#define WAVE_SPECTRUM_MAX_AGE_S (6 * SECONDS_PER_HOUR)
+#endif
+
 // IMU registers (MPU6500/9250)
 #define MPU6500_ADDR           0x68
 #define MPU6500_WHO_AM_I       0x75
@@ -48,15 +276,133 @@ static const float WAVE_FREQ_MAX = 1.0f;     // Max wave frequency (1s period)
 #define MPU6500_ACCEL_CONFIG2  0x1D
 #define MPU6500_SMPLRT_DIV     0x19
 #define MPU6500_ACCEL_XOUT_H   0x3B
+#define MPU6500_GYRO_CONFIG    0x1B
+#define MPU6500_FIFO_EN        0x23
+#define MPU6500_INT_STATUS     0x3A
+#define MPU6500_USER_CTRL      0x6A
+#define MPU6500_FIFO_COUNTH    0x72
+#define MPU6500_FIFO_R_W       0x74
+
+#define MPU6500_CONFIG_FIFO_MODE   0x40  // CONFIG: stop writing when FIFO is full (keeps frames aligned)
+#define MPU6500_FIFO_EN_ACCEL      0x08  // FIFO_EN: accel X/Y/Z (6 bytes per sample)
+#define MPU6500_FIFO_EN_GYRO       0x70  // FIFO_EN: gyro X/Y/Z (6 bytes, after accel in each frame)
+#define MPU6500_USER_CTRL_FIFO_EN  0x40
+#define MPU6500_USER_CTRL_FIFO_RST 0x04
+#define MPU6500_INT_FIFO_OFLOW     0x10  // INT_STATUS: FIFO overflow (cleared on read)
+
+#if WAVE_GYRO_ATTITUDE
+#define FIFO_FRAME_BYTES 12
+#define FIFO_EN_BITS (MPU6500_FIFO_EN_ACCEL | MPU6500_FIFO_EN_GYRO)
+#else
+#define FIFO_FRAME_BYTES 6
+#define FIFO_EN_BITS MPU6500_FIFO_EN_ACCEL
+#endif
+#define FIFO_BURST_BYTES 120             // Multiple of 6 and 12, below the 128-byte Wire buffer
+
+// Accel and gyro DLPF (ACCEL_CONFIG2.A_DLPF_CFG / CONFIG.DLPF_CFG, same code for both):
+// ~44Hz for 10Hz output as before; with oversampling about a fifth of the IMU rate,
+// and the decimating FIR removes the rest above FS_HZ/2
+#if WAVE_DECIMATE >= 10
+#define IMU_DLPF_CFG 0x04                // ~20 Hz at 100 Hz
+#elif WAVE_DECIMATE >= 4
+#define IMU_DLPF_CFG 0x05                // ~10 Hz at 40-50 Hz
+#elif WAVE_DECIMATE >= 2
+#define IMU_DLPF_CFG 0x06                // ~5 Hz at 20 Hz
+#else
+#define IMU_DLPF_CFG 0x03                // ~44 Hz
+#endif
+
+// 512-byte FIFO: 85 accel frames, 42 with gyro. Keep a drain period of headroom.
+static_assert(WAVE_FIFO_DRAIN_MS * IMU_RATE_HZ / 1000.0f * FIFO_FRAME_BYTES * 2.0f <= 512.0f,
+              "WAVE_FIFO_DRAIN_MS too long: FIFO would overflow before the next drain");
 
 // Runtime state
 static bool imuInitialized = false;
-static bool iirInitialized = false;
-
-// Collection buffer: stores heave acceleration samples
-static const uint32_t MAX_SAMPLES = 1600; // 160 s @ 10 Hz (~2:40, enough for 1024 FFT + 57s settling)
-static float accelBuf[MAX_SAMPLES];
+static bool fifoAvailable = false;       // FIFO passed the init self-check
+
+// Sample budget: settling + 1024 analysed samples (3 Welch segments): 160 s @ 10 Hz
+// (~2:40), or 112.4 s with WAVE_GYRO_ATTITUDE. The Burg engine analyses WAVE_AR_SAMPLES.
+// With WAVE_ADAPTIVE this is the cap; the consumer may stop earlier (s_stopEarly).
+#if WAVE_ADAPTIVE
+static const uint32_t MAX_SAMPLES = (uint32_t)(WAVE_ADAPTIVE_MAX_S * FS_HZ);
+static_assert(MAX_SAMPLES >= SETTLE_SAMPLES + FFT_N, "WAVE_ADAPTIVE_MAX_S must allow one Welch segment");
+static_assert(WAVE_ENGINE != WAVE_ENGINE_BURG, "WAVE_ADAPTIVE needs the Welch Hs CI; set WAVE_AR_SAMPLES instead");
+#else
+static const uint32_t MAX_SAMPLES = SETTLE_SAMPLES + ANALYSIS_SAMPLES;
+#endif
+static uint32_t s_settleSamples = SETTLE_SAMPLES;  // This collection's settling (≤ SETTLE_SAMPLES)
+static uint32_t s_sampleBudget = MAX_SAMPLES;      // This collection's frame budget (≤ MAX_SAMPLES)
 static uint32_t sampleCount = 0;
+static std::atomic<bool> s_stopEarly{false};     // Set by the consumer, read by the producer
+static const char* s_stopReason = "window";      // Why acquisition ended (adaptive log)
+
+// Acquisition counters (per recordWaveData call; written by the producer)
+static uint32_t s_rawReads = 0;          // Frames read from the IMU at IMU_RATE_HZ (accepted or rejected)
+static uint16_t s_fifoOverflows = 0;     // Drains that found the FIFO overflowed
+static uint16_t s_fifoDrains = 0;
+static bool s_acqUsedFifo = false;
+
+// Producer → consumer hand-off. Raw counts at the IMU rate, 6 bytes per frame (12 with
+// gyro): 256 frames = 25.6s at 10 Hz (2.6s at 100 Hz), far more than the consumer ever
+// lags (one FFT takes well under 10ms).
+struct RawAccel {
+  int16_t x, y, z;
+#if WAVE_GYRO_ATTITUDE
+  int16_t gx, gy, gz;
+#endif
+};
+static const uint32_t RAW_CHANNELS = sizeof(RawAccel) / sizeof(int16_t);
+static SpscRing<RawAccel, 256> s_rawRing;
+static TaskHandle_t s_imuTask = NULL;
+static TaskHandle_t s_consumerTask = NULL;
+static std::atomic<bool> s_producerDone{false};
+static bool s_inlineConsume = false;     // No producer task: process each frame as it is read
+static uint32_t s_ringDrops = 0;         // Frames dropped because the ring was full
+static uint32_t s_ringPeak = 0;          // Ring high-water mark
+
+#if WAVE_RAW_CAPTURE
+static RawAccel s_rawCapture[MAX_SAMPLES];
+static uint32_t s_rawCaptureCount = 0;
+#endif
+
+// Concurrent collection state
+static TaskHandle_t s_waveTask = NULL;
+static volatile bool s_waveConcurrent = false;   // Current/last collection runs in the wave task
+static volatile bool s_waveTaskDone = false;
+static volatile bool s_waveAbort = false;        // Set on join timeout; acquisition loops exit
+static uint32_t s_waveTaskMs = 0;                // Duration of the last wave task run
+static float s_concurrentSavedSec = 0.0f;
+static float s_oobDb = NAN;                      // Out-of-band PSD level of the last collection
+static float s_modemNoiseDb = NAN;
+
+// Spectrum: heave samples after settling go into a streaming Welch analyzer
+// (wave_analyzer.h). They are stored as int16; full scale ±8 m/s² leaves headroom
+// over the ±5 m/s² clamp for bandLimit() overshoot.
+// Wave band bins 3..51 (0.059-0.996 Hz) for 512 points at 10Hz; bins below
+// WAVE_FREQ_MIN are excluded because 1/ω⁴ amplifies their noise catastrophically.
+// With WAVE_BANDLIMIT_SPECTRAL the displacement weights also undo the gravity
+// tracker's high-pass response (heave = x − LP(x)).
+struct WaveOptions : WaveAnalyzerOptions {
+  static constexpr float FREQ_MIN = WAVE_FREQ_MIN;
+  static constexpr float FREQ_MAX = WAVE_FREQ_MAX;
+  static constexpr float HEAVE_FULL_SCALE = 8.0f;
+  static constexpr bool DFT_BANK = (WAVE_ENGINE == WAVE_ENGINE_DFTBANK);
+  static constexpr double TRACKER_FC_HZ = WAVE_BANDLIMIT_SPECTRAL ? (double)G_TRACK_FC_HZ : 0.0;
+  static constexpr uint32_t ZOOM = (WAVE_ENGINE == WAVE_ENGINE_FFT) ? WAVE_TP_ZOOM : 0;
+  static constexpr bool WAVE_HEIGHTS = WAVE_ZERO_CROSSING;
+};
+static_assert(FS_HZ == (float)(uint32_t)FS_HZ, "WaveAnalyzer needs an integer sample rate");
+#if WAVE_ENGINE == WAVE_ENGINE_BURG
+typedef ArWaveAnalyzer<WAVE_AR_SAMPLES, (uint32_t)FS_HZ, WAVE_AR_ORDER, WaveOptions> Analyzer;
+#else
+typedef WaveAnalyzer<FFT_N, (uint32_t)FS_HZ, WaveOptions> Analyzer;
+#endif
+static Analyzer s_analyzer;
+static float s_hsCi = NAN;                   // 95% CI half-width of the last Hs (m)
+static float s_hsAvg = NAN;                  // Hs/Tp of the RTC spectrum average (NAN = not updated)
+static float s_tpAvg = NAN;
+static uint8_t s_spectrum[WAVE_SPECTRUM_BINS];  // This wake's quantised spectrum (for upload)
+static bool s_spectrumValid = false;
 
 // Running heave acceleration stats (computed incrementally)
 static double s_heaveAbsSum = 0.0;
@@ -66,20 +412,37 @@ static uint32_t s_heaveStatCount = 0;
 // Gravity tracker state (reset each recordWaveData call)
 static float g_lp_x = 0.0f, g_lp_y = 0.0f, g_lp_z = 9.80665f;
 
+#if WAVE_GYRO_ATTITUDE
+// Gyro-aided gravity estimate: Mahony-style complementary filter in the body frame.
+// att_v (unit gravity direction) is propagated with the bias-corrected gyro and
+// pulled toward the accel direction with gain ATT_KP; ATT_KI integrates the
+// remaining error into the gyro bias. ATT_KP = 2π·G_TRACK_FC_HZ, so wave
+// accelerations leak into the estimate no more than with the accel-only tracker,
+// while real rotations are followed by the gyro. g_lp_* = att_mag · att_v.
+static const uint32_t ATT_ALIGN_SAMPLES = 20;            // 2s accel average seeds att_v/att_mag
+static const float ATT_KP = 2.0f * PI * G_TRACK_FC_HZ;   // rad/s per rad of error
+static const float ATT_KI = ATT_KP * ATT_KP / 4.0f;      // Critically damped bias loop
+static float att_vx = 0.0f, att_vy = 0.0f, att_vz = 1.0f;
+static float att_mag = 9.80665f;
+static float att_bx = 0.0f, att_by = 0.0f, att_bz = 0.0f; // Gyro bias estimate (rad/s)
+static uint32_t att_alignCount = 0;
+static double att_alignSum[3];
+static double att_gyroSum[3];                            // Window mean → rtcState.gyroBias
+static uint32_t att_gyroCount = 0;
+#endif
+
 // Last computed results for public getters
 static float s_lastHs = 0.0f;
 static float s_lastTp = 0.0f;
 static uint16_t s_lastWaves = 0;
+static SpectralMoments s_lastMoments = {};   // Zeroed whenever Hs is
+static WaveHeightStats s_lastHeights = {};   // Zero-upcrossing stats (WAVE_ZERO_CROSSING), ditto
 
 // Tilt and acceleration metrics (computed incrementally during sampling)
 static double s_tiltSum = 0.0;
 static uint32_t s_tiltCount = 0;
 static float s_accelRms = 0.0f;
 
-// IIR bandpass filter state for acceleration pre-filtering
-static float a_hp, b_hp, a_lp, b_lp;
-static float hp_y_prev = 0.0f, hp_x_prev = 0.0f;
-static float lp_y_prev = 0.0f;
 
 // I2C helpers
 static inline bool i2cWrite(uint8_t reg, uint8_t val) {
@@ -99,6 +462,33 @@ static inline bool i2cReadBytes(uint8_t reg, uint8_t count, uint8_t* out) {
   return true;
 }
 
+// ---- FIFO helpers ----
+
+// Resets the FIFO and starts logging accel frames at the sample rate.
+// CONFIG.FIFO_MODE (set in initMPU6500) stops writes when full, so an overflow
+// drops the newest samples but never misaligns the 6-byte frames.
+static bool fifoStart() {
+  if (!i2cWrite(MPU6500_FIFO_EN, 0x00)) return false;
+  if (!i2cWrite(MPU6500_USER_CTRL, MPU6500_USER_CTRL_FIFO_RST)) return false;
+  delay(1);
+  uint8_t status;
+  i2cReadBytes(MPU6500_INT_STATUS, 1, &status);  // Clear a stale overflow flag
+  if (!i2cWrite(MPU6500_USER_CTRL, MPU6500_USER_CTRL_FIFO_EN)) return false;
+  return i2cWrite(MPU6500_FIFO_EN, FIFO_EN_BITS);
+}
+
+static void fifoStop() {
+  i2cWrite(MPU6500_FIFO_EN, 0x00);
+  i2cWrite(MPU6500_USER_CTRL, 0x00);
+}
+
+// Bytes currently in the FIFO (13-bit count), or -1 on I2C error
+static int fifoCount() {
+  uint8_t buf[2];
+  if (!i2cReadBytes(MPU6500_FIFO_COUNTH, 2, buf)) return -1;
+  return ((buf[0] & 0x1F) << 8) | buf[1];
+}
+
 static bool initMPU6500() {
   SerialMon.println("Initializing MPU6500 directly...");
 
@@ -134,8 +524,8 @@ static bool initMPU6500() {
     return false;
   }
 
-  // DLPF
-  if (!i2cWrite(MPU6500_CONFIG, 0x03)) {
+  // DLPF (+ FIFO stop-when-full mode; harmless when the FIFO is unused)
+  if (!i2cWrite(MPU6500_CONFIG, IMU_DLPF_CFG | MPU6500_CONFIG_FIFO_MODE)) {
     SerialMon.println("Failed to configure low-pass filter");
     return false;
   }
@@ -146,18 +536,43 @@ static bool initMPU6500() {
     return false;
   }
 
-  // Accel DLPF ~44 Hz
-  if (!i2cWrite(MPU6500_ACCEL_CONFIG2, 0x03)) {
+  // Accel DLPF (~44 Hz without oversampling)
+  if (!i2cWrite(MPU6500_ACCEL_CONFIG2, IMU_DLPF_CFG)) {
     SerialMon.println("Failed to configure accelerometer DLPF");
     return false;
   }
 
-  // Sample rate divider for 10 Hz (1 kHz base when DLPF enabled)
-  if (!i2cWrite(MPU6500_SMPLRT_DIV, 99)) {
+#if WAVE_GYRO_ATTITUDE
+  // Gyro +/-250 dps (DLPF from CONFIG)
+  if (!i2cWrite(MPU6500_GYRO_CONFIG, 0x00)) {
+    SerialMon.println("Failed to configure gyroscope");
+    return false;
+  }
+#endif
+
+  // Sample rate divider for IMU_RATE_HZ (1 kHz base when DLPF enabled)
+  if (!i2cWrite(MPU6500_SMPLRT_DIV, IMU_SMPLRT_DIV)) {
     SerialMon.println("Failed to configure sample rate divider");
     return false;
   }
 
+#if WAVE_USE_FIFO
+  // FIFO self-check: at ≥10 Hz, 350 ms must leave at least 2 whole frames
+  fifoAvailable = false;
+  int fifoBytes = -1;
+  if (fifoStart()) {
+    delay(350);
+    fifoBytes = fifoCount();
+    fifoAvailable = (fifoBytes >= 2 * FIFO_FRAME_BYTES);
+  }
+  fifoStop();
+  if (fifoAvailable) {
+    SerialMon.printf("MPU6500 FIFO OK (%d bytes in 350ms)\n", fifoBytes);
+  } else {
+    SerialMon.printf("MPU6500 FIFO check failed (%d bytes) — using polled sampling\n", fifoBytes);
+  }
+#endif
+
   SerialMon.println("MPU6500 initialized successfully!");
   imuInitialized = true;
   return true;
@@ -166,215 +581,593 @@ static bool initMPU6500() {
 // ±2g: 16384 LSB/g → 9.80665/16384 m/s² per LSB
 static const float ACCEL_SCALE = 9.80665f / 16384.0f;
 
-static void readMPU6500(float &ax, float &ay, float &az) {
+// Raw accel counts (big-endian X, Y, Z) — same layout as a FIFO frame
+static inline RawAccel decodeAccel(const uint8_t* b) {
+  RawAccel r;
+  r.x = (int16_t)((b[0] << 8) | b[1]);
+  r.y = (int16_t)((b[2] << 8) | b[3]);
+  r.z = (int16_t)((b[4] << 8) | b[5]);
+  return r;
+}
+
+#if WAVE_GYRO_ATTITUDE
+static const float GYRO_SCALE = (PI / 180.0f) / 131.0f;  // rad/s per LSB at ±250 dps
+
+// FIFO frame: accel X/Y/Z then gyro X/Y/Z (register order, temperature not enabled)
+static inline RawAccel decodeFrame(const uint8_t* b) {
+  RawAccel r = decodeAccel(b);
+  r.gx = (int16_t)((b[6] << 8) | b[7]);
+  r.gy = (int16_t)((b[8] << 8) | b[9]);
+  r.gz = (int16_t)((b[10] << 8) | b[11]);
+  return r;
+}
+
+// ACCEL_XOUT_H..GYRO_ZOUT_L in one burst, dropping the temperature word
+static bool readMPU6500Raw(RawAccel& out) {
+  uint8_t buf[14];
+  if (!i2cReadBytes(MPU6500_ACCEL_XOUT_H, 14, buf)) return false;
+  memmove(buf + 6, buf + 8, 6);
+  out = decodeFrame(buf);
+  return true;
+}
+#else
+static inline RawAccel decodeFrame(const uint8_t* b) { return decodeAccel(b); }
+
+static bool readMPU6500Raw(RawAccel& out) {
   uint8_t buf[6];
-  if (!i2cReadBytes(MPU6500_ACCEL_XOUT_H, 6, buf)) {
-    ax = ay = az = 0.0f;
-    return;
+  if (!i2cReadBytes(MPU6500_ACCEL_XOUT_H, 6, buf)) return false;
+  out = decodeAccel(buf);
+  return true;
+}
+#endif
+
+#if !WAVE_BANDLIMIT_SPECTRAL
+// Heave band-pass: HP then LP, coefficients designed by the compiler
+static_assert(WAVE_HP_CUTOFF_HZ > 0.0f && WAVE_HP_CUTOFF_HZ < WAVE_LP_CUTOFF_HZ &&
+              WAVE_LP_CUTOFF_HZ < FS_HZ / 2.0f, "need 0 < HP cutoff < LP cutoff < fs/2");
+static constexpr Sos<HP_SECTIONS + LP_SECTIONS> BAND_SOS =
+    sosCascade(butterworthHighpass<HP_SECTIONS>(WAVE_HP_CUTOFF_HZ, FS_HZ),
+               butterworthLowpass<LP_SECTIONS>(WAVE_LP_CUTOFF_HZ, FS_HZ));
+static_assert(sosGainSq(butterworthHighpass<HP_SECTIONS>(WAVE_HP_CUTOFF_HZ, FS_HZ),
+                        WAVE_HP_CUTOFF_HZ, FS_HZ) > 0.499 &&
+              sosGainSq(butterworthHighpass<HP_SECTIONS>(WAVE_HP_CUTOFF_HZ, FS_HZ),
+                        WAVE_HP_CUTOFF_HZ, FS_HZ) < 0.501,
+              "HP design is not -3dB at its cutoff");
+static_assert(sosGainSq(butterworthLowpass<LP_SECTIONS>(WAVE_LP_CUTOFF_HZ, FS_HZ),
+                        WAVE_LP_CUTOFF_HZ, FS_HZ) > 0.499 &&
+              sosGainSq(butterworthLowpass<LP_SECTIONS>(WAVE_LP_CUTOFF_HZ, FS_HZ),
+                        WAVE_LP_CUTOFF_HZ, FS_HZ) < 0.501,
+              "LP design is not -3dB at its cutoff");
+
+static SosFilter<HP_SECTIONS + LP_SECTIONS> s_bandFilter(BAND_SOS);
+
+static inline float bandLimit(float xin) { return s_bandFilter.process(xin); }
+#endif
+
+#if WAVE_DSP_ESPDSP && WAVE_DSP_SELFTEST && WAVE_ENGINE == WAVE_ENGINE_FFT
+// Cross-check of the esp-dsp FFT against the portable one on a fixed test signal
+// (two tones + broadband LCG noise). Uses the analyzer's FFT scratch, so call it
+// only before s_analyzer.reset(). The reference copy is a 2KB stack buffer.
+static void dspCrossCheck() {
+  static bool done = false;
+  if (done) return;
+  done = true;
+
+  static const int ITER = 8;
+  float ref[FFT_N];
+  uint32_t lcg = 12345;
+  for (uint32_t i = 0; i < FFT_N; i++) {
+    lcg = lcg * 1664525UL + 1013904223UL;
+    float noise = ((float)(lcg >> 8) / 16777216.0f - 0.5f) * 0.1f;
+    ref[i] = 0.8f * sinf(2.0f * PI * 0.25f * i / FS_HZ) +
+             0.3f * sinf(2.0f * PI * 1.3f * i / FS_HZ) + noise;
   }
-  int16_t accelX = (int16_t)((buf[0] << 8) | buf[1]);
-  int16_t accelY = (int16_t)((buf[2] << 8) | buf[3]);
-  int16_t accelZ = (int16_t)((buf[4] << 8) | buf[5]);
 
-  ax = accelX * ACCEL_SCALE;
-  ay = accelY * ACCEL_SCALE;
-  az = accelZ * ACCEL_SCALE;
+  // Warm-up call so the esp-dsp twiddle table init is not timed
+  float* seg = s_analyzer.scratch();
+  memcpy(seg, ref, sizeof(ref));
+  dspRealFft<FFT_N>(seg);
+
+  // Timed runs: esp-dsp, then portable (seg holds the portable result afterwards)
+  int64_t t0 = esp_timer_get_time();
+  for (int it = 0; it < ITER; it++) {
+    memcpy(seg, ref, sizeof(ref));
+    dspRealFft<FFT_N>(seg);
+  }
+  int64_t t1 = esp_timer_get_time();
+  for (int it = 0; it < ITER; it++) {
+    memcpy(seg, ref, sizeof(ref));
+    Analyzer::Fft::forward(seg);
+  }
+  int64_t t2 = esp_timer_get_time();
+
+  // esp-dsp result in ref, compared relative to the largest bin magnitude
+  dspRealFft<FFT_N>(ref);
+  float maxAbs = 0.0f, maxErr = 0.0f;
+  for (uint32_t i = 0; i < FFT_N; i++) {
+    maxAbs = std::max(maxAbs, fabsf(seg[i]));
+    maxErr = std::max(maxErr, fabsf(seg[i] - ref[i]));
+  }
+  float relErr = (maxAbs > 0.0f) ? maxErr / maxAbs : 0.0f;
+
+  const uint32_t mhz = getCpuFrequencyMhz();
+  const uint32_t espCycles = (uint32_t)((t1 - t0) * mhz / ITER);
+  const uint32_t portCycles = (uint32_t)((t2 - t1) * mhz / ITER);
+  SerialMon.printf("DSP cross-check (%u-pt real FFT): %s %u cycles, portable %u cycles (%.1fx), max rel err %.1e%s\n",
+                   FFT_N, dspBackendName(), espCycles, portCycles,
+                   espCycles > 0 ? (float)portCycles / (float)espCycles : 0.0f,
+                   relErr, relErr < 1e-4f ? "" : " — MISMATCH");
 }
+#endif
 
-static void computeIIRCoeffs(float fs, float fc_hp, float fc_lp) {
-  float dt = 1.0f / fs;
-  float RC_hp = 1.0f / (2.0f * PI * fc_hp);
-  float alpha_hp = RC_hp / (RC_hp + dt);
-  a_hp = alpha_hp; b_hp = alpha_hp;
-  float RC_lp = 1.0f / (2.0f * PI * fc_lp);
-  float alpha_lp = dt / (RC_lp + dt);
-  a_lp = alpha_lp; b_lp = 1.0f - alpha_lp;
+// Calm gate: essentially no heave acceleration over the samples so far
+static bool heaveIsCalm() {
+  if (s_heaveStatCount == 0) return true;
+  const float rms = sqrtf((float)(s_heaveSqSum / (double)s_heaveStatCount));
+  const float meanAbs = (float)(s_heaveAbsSum / (double)s_heaveStatCount);
+  return rms < 0.01f && meanAbs < 0.005f;
 }
 
-static inline float bandLimit(float xin) {
-  float y_hp = a_hp * (hp_y_prev + xin - hp_x_prev);
-  hp_x_prev = xin;
-  hp_y_prev = y_hp;
-  float y_lp = a_lp * y_hp + b_lp * lp_y_prev;
-  lp_y_prev = y_lp;
-  return y_lp;
+#if WAVE_ADAPTIVE
+// Runs on the consumer at every Welch hop after settling, i.e. right after each
+// segment finishes. Stopping is a request: the producer sees s_stopEarly at its
+// next read, and frames already in the ring are still processed.
+static void adaptiveCheck() {
+  if (s_stopEarly.load(std::memory_order_relaxed)) return;
+
+  float hs = 0.0f;
+  const float ci = s_analyzer.hsConfidence(&hs);
+  const char* reason = NULL;
+  if (heaveIsCalm()) {
+    reason = "calm";
+  } else if (!isnan(ci) && (ci <= WAVE_ADAPTIVE_CI_REL * hs || ci <= WAVE_ADAPTIVE_CI_ABS_M)) {
+    reason = "converged";
+  }
+  SerialMon.printf("Adaptive window: %.0f s, %u segments, Hs %.3f ± %.3f m%s%s\n",
+                   sampleCount / FS_HZ, s_analyzer.segments(), hs, isnan(ci) ? 0.0f : ci,
+                   reason ? " → stop, " : "", reason ? reason : "");
+  if (!reason) return;
+  s_stopReason = reason;
+  s_stopEarly.store(true, std::memory_order_release);
 }
+#endif
 
-// ---- FFT implementation (radix-2 Cooley-Tukey, in-place) ----
+#if WAVE_GYRO_ATTITUDE
+// Starts from the gyro bias learned in previous cycles, if any
+static void attitudeReset() {
+  att_vx = 0.0f; att_vy = 0.0f; att_vz = 1.0f;
+  att_mag = 9.80665f;
+  if (rtcState.gyroBiasValid) {
+    att_bx = rtcState.gyroBias[0]; att_by = rtcState.gyroBias[1]; att_bz = rtcState.gyroBias[2];
+  } else {
+    att_bx = att_by = att_bz = 0.0f;
+  }
+  att_alignCount = 0;
+  att_gyroCount = 0;
+  for (int i = 0; i < 3; i++) att_alignSum[i] = att_gyroSum[i] = 0.0;
+}
 
-// Imaginary part buffer (reused from static allocation)
-static float fftIm[FFT_N];
+// Gyro prediction for every frame (rad/s). A world-fixed vector seen from the body
+// evolves as dv/dt = v × ω.
+static void attitudePredict(float wx, float wy, float wz) {
+  att_gyroSum[0] += wx; att_gyroSum[1] += wy; att_gyroSum[2] += wz;
+  att_gyroCount++;
+  if (att_alignCount < ATT_ALIGN_SAMPLES) return;
+
+  const float dt = 1.0f / FS_HZ;
+  wx -= att_bx; wy -= att_by; wz -= att_bz;
+  float vx = att_vx + dt * (att_vy * wz - att_vz * wy);
+  float vy = att_vy + dt * (att_vz * wx - att_vx * wz);
+  float vz = att_vz + dt * (att_vx * wy - att_vy * wx);
+  const float n = sqrtf(vx * vx + vy * vy + vz * vz);
+  att_vx = vx / n; att_vy = vy / n; att_vz = vz / n;
+}
 
-static void fftInPlace(float* re, float* im, uint32_t n) {
-  // Bit-reversal permutation
-  uint32_t j = 0;
-  for (uint32_t i = 0; i < n - 1; i++) {
-    if (i < j) {
-      float tr = re[i]; re[i] = re[j]; re[j] = tr;
-      float ti = im[i]; im[i] = im[j]; im[j] = ti;
-    }
-    uint32_t k = n >> 1;
-    while (k <= j) { j -= k; k >>= 1; }
-    j += k;
-  }
-  // Cooley-Tukey butterfly
-  for (uint32_t len = 2; len <= n; len <<= 1) {
-    float angle = -2.0f * PI / (float)len;
-    float wr = cosf(angle), wi = sinf(angle);
-    for (uint32_t i = 0; i < n; i += len) {
-      float wr_k = 1.0f, wi_k = 0.0f;
-      for (uint32_t k = 0; k < len / 2; k++) {
-        uint32_t u = i + k, v = i + k + len / 2;
-        float tr = wr_k * re[v] - wi_k * im[v];
-        float ti = wr_k * im[v] + wi_k * re[v];
-        re[v] = re[u] - tr;
-        im[v] = im[u] - ti;
-        re[u] += tr;
-        im[u] += ti;
-        float new_wr = wr_k * wr - wi_k * wi;
-        wi_k = wr_k * wi + wi_k * wr;
-        wr_k = new_wr;
-      }
-    }
+// Accel correction for accepted samples; updates g_lp_*. Returns false while the
+// first ATT_ALIGN_SAMPLES are still being averaged.
+static bool attitudeCorrect(float ax, float ay, float az, float amag) {
+  if (att_alignCount < ATT_ALIGN_SAMPLES) {
+    att_alignSum[0] += ax; att_alignSum[1] += ay; att_alignSum[2] += az;
+    if (++att_alignCount < ATT_ALIGN_SAMPLES) return false;
+    const float mx = (float)(att_alignSum[0] / ATT_ALIGN_SAMPLES);
+    const float my = (float)(att_alignSum[1] / ATT_ALIGN_SAMPLES);
+    const float mz = (float)(att_alignSum[2] / ATT_ALIGN_SAMPLES);
+    att_mag = sqrtf(mx * mx + my * my + mz * mz);
+    att_vx = mx / att_mag; att_vy = my / att_mag; att_vz = mz / att_mag;
+    g_lp_x = mx; g_lp_y = my; g_lp_z = mz;
+    return false;
   }
+
+  // e = â × v; v += Kp·dt·(v × e) = Kp·dt·(â − (â·v)v), bias -= Ki·dt·e
+  const float dt = 1.0f / FS_HZ;
+  const float hx = ax / amag, hy = ay / amag, hz = az / amag;
+  const float ex = hy * att_vz - hz * att_vy;
+  const float ey = hz * att_vx - hx * att_vz;
+  const float ez = hx * att_vy - hy * att_vx;
+  att_bx -= ATT_KI * dt * ex; att_by -= ATT_KI * dt * ey; att_bz -= ATT_KI * dt * ez;
+  const float dot = hx * att_vx + hy * att_vy + hz * att_vz;
+  float vx = att_vx + ATT_KP * dt * (hx - dot * att_vx);
+  float vy = att_vy + ATT_KP * dt * (hy - dot * att_vy);
+  float vz = att_vz + ATT_KP * dt * (hz - dot * att_vz);
+  const float n = sqrtf(vx * vx + vy * vy + vz * vz);
+  att_vx = vx / n; att_vy = vy / n; att_vz = vz / n;
+
+  // Gravity magnitude (sensor scale) tracked as slowly as the accel-only tracker
+  const float RC = 1.0f / (2.0f * PI * G_TRACK_FC_HZ);
+  const float alpha = dt / (RC + dt);
+  att_mag += alpha * ((ax * att_vx + ay * att_vy + az * att_vz) - att_mag);
+  g_lp_x = att_mag * att_vx; g_lp_y = att_mag * att_vy; g_lp_z = att_mag * att_vz;
+  return true;
 }
 
-// Spectral wave analysis results
-struct SpectralWaveStats {
-  float Hs;       // Significant wave height (m)
-  float Tp;       // Peak period (s)
-  float P;        // Wave power proxy (kW/m)
-  uint16_t nBins; // Number of spectral bins in wave band
-};
+// Window-mean gyro → rtcState bias for the next cycle. Rocking averages out and
+// yaw about the vertical does not move the gravity direction.
+static void attitudeSaveBias() {
+  if (att_gyroCount < (uint32_t)(30 * FS_HZ)) return;
+  float b[3];
+  for (int i = 0; i < 3; i++) b[i] = (float)(att_gyroSum[i] / (double)att_gyroCount);
+  for (int i = 0; i < 3; i++) {
+    rtcState.gyroBias[i] = rtcState.gyroBiasValid ? 0.5f * (rtcState.gyroBias[i] + b[i]) : b[i];
+  }
+  rtcState.gyroBiasValid = 1;
+  SerialMon.printf("Gyro bias: %.2f %.2f %.2f dps (filter ended at %.2f %.2f %.2f)\n",
+                   b[0] * 57.2958f, b[1] * 57.2958f, b[2] * 57.2958f,
+                   att_bx * 57.2958f, att_by * 57.2958f, att_bz * 57.2958f);
+}
+#endif
+
+// Runs one accelerometer sample through gravity removal, heave projection and
+// band-limiting, then into the Welch estimator and running stats.
+// Returns false if the sample was rejected (magnitude far from 1g).
+static bool processSample(float ax, float ay, float az) {
+  // Sanity: discard if accel magnitude far from 1g
+  float amag = sqrtf(ax * ax + ay * ay + az * az);
+  if (fabsf(amag - 9.80665f) > 4.9f) return false;
+
+#if WAVE_GYRO_ATTITUDE
+  // Gyro-aided gravity estimate; alignment samples only count towards settling
+  if (!attitudeCorrect(ax, ay, az, amag)) {
+    sampleCount++;
+    return true;
+  }
+#else
+  // Slow gravity tracker in body frame
+  const float dt = 1.0f / FS_HZ;
+  const float RC = 1.0f / (2.0f * PI * G_TRACK_FC_HZ);
+  const float alpha = dt / (RC + dt);
+  g_lp_x = (1.0f - alpha) * g_lp_x + alpha * ax;
+  g_lp_y = (1.0f - alpha) * g_lp_y + alpha * ay;
+  g_lp_z = (1.0f - alpha) * g_lp_z + alpha * az;
+#endif
+
+  // Specific force (acceleration minus gravity)
+  const float ax_spec = ax - g_lp_x;
+  const float ay_spec = ay - g_lp_y;
+  const float az_spec = az - g_lp_z;
+  float gnorm = sqrtf(g_lp_x * g_lp_x + g_lp_y * g_lp_y + g_lp_z * g_lp_z);
+  if (gnorm < 1e-3f) gnorm = 9.80665f;
+
+  // Tilt: angle between gravity vector and vertical (z-axis)
+  float cosAngle = g_lp_z / gnorm;
+  if (cosAngle > 1.0f) cosAngle = 1.0f;
+  if (cosAngle < -1.0f) cosAngle = -1.0f;
+  s_tiltSum += (double)(acosf(cosAngle) * 57.2958f);
+  s_tiltCount++;
+
+  // Project specific force onto gravity direction to get heave acceleration
+  const float ux = g_lp_x / gnorm, uy = g_lp_y / gnorm, uz = g_lp_z / gnorm;
+  float heaveAcc = -(ax_spec * ux + ay_spec * uy + az_spec * uz);
+  if (fabsf(heaveAcc) < 0.001f) heaveAcc = 0.0f;
+  if (heaveAcc > 5.0f) heaveAcc = 5.0f;
+  else if (heaveAcc < -5.0f) heaveAcc = -5.0f;
+
+#if WAVE_BANDLIMIT_SPECTRAL
+  const float a_heave = heaveAcc;  // Band cut in the spectral weights
+#else
+  // Light band-limit before storing (anti-alias for FFT)
+  float a_heave = bandLimit(heaveAcc);
+#endif
 
-static SpectralWaveStats spectralAnalysis(float* accel, uint32_t nSamples, float fs) {
-  SpectralWaveStats result = {0.0f, 0.0f, 0.0f, 0};
+  // Feed settled samples into the streaming Welch estimator
+  if (sampleCount >= s_settleSamples) s_analyzer.push(a_heave);
+  sampleCount++;
 
-  if (nSamples < FFT_N) return result;
+  // Track heave acceleration stats incrementally
+  s_heaveAbsSum += fabsf(a_heave);
+  s_heaveSqSum += (double)a_heave * (double)a_heave;
+  s_heaveStatCount++;
 
-  // Use last FFT_N samples (skip initial transients).
-  // re aliases accel (same buffer), so the memset that was here WOULD zero the
-  // source data for any offset > 0. Use memmove instead; it handles overlap correctly.
-  uint32_t offset = nSamples - FFT_N;
-  float* re = accel;
-  if (offset > 0) {
-    memmove(re, accel + offset, FFT_N * sizeof(float));
+#if WAVE_ADAPTIVE
+  if (sampleCount > s_settleSamples && ((sampleCount - s_settleSamples) % WELCH_HOP) == 0) {
+    adaptiveCheck();
   }
+#endif
+  return true;
+}
 
-  // Remove mean (DC offset)
-  double mean = 0.0;
-  for (uint32_t i = 0; i < FFT_N; i++) mean += re[i];
-  mean /= (double)FFT_N;
-  for (uint32_t i = 0; i < FFT_N; i++) re[i] -= (float)mean;
+static inline void processRaw(const RawAccel& r) {
+#if WAVE_RAW_CAPTURE
+  if (s_rawCaptureCount < MAX_SAMPLES) s_rawCapture[s_rawCaptureCount++] = r;
+#endif
+#if WAVE_GYRO_ATTITUDE
+  attitudePredict(r.gx * GYRO_SCALE, r.gy * GYRO_SCALE, r.gz * GYRO_SCALE);
+#endif
+  processSample(r.x * ACCEL_SCALE, r.y * ACCEL_SCALE, r.z * ACCEL_SCALE);
+}
 
-  // Apply Hanning window
-  for (uint32_t i = 0; i < FFT_N; i++) {
-    float w = 0.5f * (1.0f - cosf(2.0f * PI * (float)i / (float)(FFT_N - 1)));
-    re[i] *= w;
-  }
-
-  // Zero imaginary part
-  memset(fftIm, 0, sizeof(float) * FFT_N);
-
-  // Compute FFT
-  fftInPlace(re, fftIm, FFT_N);
-
-  // Compute one-sided acceleration power spectral density (PSD)
-  // PSD(f) = 2 * |X(f)|^2 / (N * fs) for f > 0
-  // The factor of 2 accounts for folding the negative frequencies
-  // Hanning window correction factor: 1/mean(w^2) = 8/3
-  float df = fs / (float)FFT_N;
-  float psdScale = 2.0f / ((float)FFT_N * fs) * (8.0f / 3.0f); // includes window correction
-
-  // Spectral integration for wave parameters
-  // Displacement PSD = Acceleration PSD / (2*pi*f)^4
-  uint32_t binMin = (uint32_t)(WAVE_FREQ_MIN / df);
-  uint32_t binMax = (uint32_t)(WAVE_FREQ_MAX / df);
-  if (binMin < 1) binMin = 1; // Skip DC
-  if (binMax > FFT_N / 2) binMax = FFT_N / 2;
-
-  double m0 = 0.0;          // Zeroth moment (displacement variance)
-  float peakPsd = 0.0f;
-  uint32_t peakBin = binMin;
-
-  for (uint32_t k = binMin; k <= binMax; k++) {
-    float accelPsd = (re[k] * re[k] + fftIm[k] * fftIm[k]) * psdScale;
-    float f = (float)k * df;
-
-    // Low-frequency cutoff: zero PSD below WAVE_FREQ_MIN to prevent 1/ω⁴ blowup
-    // At very low frequencies, ω becomes tiny, so 1/ω⁴ amplifies noise catastrophically
-    if (f < WAVE_FREQ_MIN) {
-      continue;  // Skip this bin
-    }
+#if WAVE_DECIMATE > 1
+static const uint32_t DECIM_TAPS_PER_PHASE = 10;   // flat to 3Hz, ≥78dB down from 8Hz
+static FirDecimator<WAVE_DECIMATE, DECIM_TAPS_PER_PHASE, RAW_CHANNELS, int16_t> s_decimator;
 
-    float omega = 2.0f * PI * f;
-    float omega4 = omega * omega * omega * omega;
+static inline int16_t toCount(float v) {
+  if (v > 32767.0f) return 32767;
+  if (v < -32768.0f) return -32768;
+  return (int16_t)lroundf(v);
+}
+#endif
+
+// One IMU frame into the pipeline. With oversampling, every WAVE_DECIMATE-th call
+// hands a decimated frame to processRaw(), rounded back to counts (0.3 LSB rms,
+// ~30dB below the sensor noise) so raw capture and processing are unchanged.
+static inline void consumeFrame(const RawAccel& r) {
+#if WAVE_DECIMATE > 1
+#if WAVE_GYRO_ATTITUDE
+  const int16_t in[RAW_CHANNELS] = {r.x, r.y, r.z, r.gx, r.gy, r.gz};
+#else
+  const int16_t in[RAW_CHANNELS] = {r.x, r.y, r.z};
+#endif
+  float out[RAW_CHANNELS];
+  if (!s_decimator.push(in, out)) return;
+  RawAccel d;
+  d.x = toCount(out[0]); d.y = toCount(out[1]); d.z = toCount(out[2]);
+#if WAVE_GYRO_ATTITUDE
+  d.gx = toCount(out[3]); d.gy = toCount(out[4]); d.gz = toCount(out[5]);
+#endif
+  processRaw(d);
+#else
+  processRaw(r);
+#endif
+}
+
+// ---- IMU producer ----
+//
+// The producer only talks to the sensor: it reads frames (FIFO bursts or polled
+// register reads) and pushes the raw counts into s_rawRing. The consumer — the
+// task that called recordWaveData() or the concurrent wave task — pops them and
+// does gravity tracking, filtering and the per-segment Welch FFTs, so the
+// spectrum is complete as soon as the last frame is consumed.
+
+static void emitRaw(const RawAccel& r) {
+  s_rawReads++;
+  if (s_inlineConsume) {
+    consumeFrame(r);
+    return;
+  }
+  if (!s_rawRing.push(r)) {
+    s_ringDrops++;
+    return;
+  }
+  uint32_t fill = s_rawRing.size();
+  if (fill > s_ringPeak) s_ringPeak = fill;
+}
+
+static inline void notifyConsumer() {
+  if (!s_inlineConsume && s_consumerTask != NULL) xTaskNotifyGive(s_consumerTask);
+}
+
+// Only the inline (no producer task) path runs on a watchdog-subscribed task
+static inline void producerWdtReset() {
+  if (s_inlineConsume) esp_task_wdt_reset();
+}
 
-    // Displacement PSD = acceleration PSD / omega^4
-    float dispPsd = accelPsd / omega4;
+// IMU frames the producer still has to read (0 once the consumer has stopped early)
+static inline uint32_t framesWanted() {
+  if (s_stopEarly.load(std::memory_order_acquire)) return 0;
+  return s_sampleBudget * WAVE_DECIMATE - s_rawReads;
+}
 
-    m0 += (double)dispPsd * (double)df;
+// Reads every whole frame in the FIFO (up to the sample budget) in bursts and
+// emits it. Returns false on an I2C error.
+static bool fifoDrain() {
+  uint8_t status = 0;
+  if (i2cReadBytes(MPU6500_INT_STATUS, 1, &status) && (status & MPU6500_INT_FIFO_OFLOW)) {
+    s_fifoOverflows++;
+  }
 
-    if (dispPsd > peakPsd) {
-      peakPsd = dispPsd;
-      peakBin = k;
+  int count = fifoCount();
+  if (count < 0) return false;
+  uint32_t frames = (uint32_t)count / FIFO_FRAME_BYTES;
+  frames = std::min(frames, framesWanted());
+
+  uint8_t buf[FIFO_BURST_BYTES];
+  while (frames > 0) {
+    uint32_t n = std::min<uint32_t>(frames, FIFO_BURST_BYTES / FIFO_FRAME_BYTES);
+    if (!i2cReadBytes(MPU6500_FIFO_R_W, (uint8_t)(n * FIFO_FRAME_BYTES), buf)) return false;
+    for (uint32_t i = 0; i < n; i++) emitRaw(decodeFrame(buf + i * FIFO_FRAME_BYTES));
+    frames -= n;
+  }
+  s_fifoDrains++;
+  return true;
+}
+
+// Waits between FIFO drains; light sleep keeps RAM, the I2C peripheral and GPIO
+// state, and the FIFO keeps filling on the IMU's own clock.
+static void fifoIdle(uint32_t ms) {
+#if WAVE_FIFO_LIGHT_SLEEP
+  if (s_waveConcurrent) {  // Light sleep would stop the modem/GNSS work on the other core
+    vTaskDelay(pdMS_TO_TICKS(ms));
+    return;
+  }
+  SerialMon.flush();
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+  esp_err_t err = esp_light_sleep_start();
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+  if (err == ESP_OK) return;
+#endif
+  delay(ms);
+}
+
+// FIFO acquisition: s_sampleBudget frames at the IMU sample rate, drained every
+// WAVE_FIFO_DRAIN_MS. Returns false if the FIFO could not be started or read;
+// the caller then finishes the window with polled sampling.
+static bool acquireFifo(uint32_t start) {
+  if (!fifoStart()) {
+    SerialMon.println("FIFO start failed — falling back to polled sampling");
+    return false;
+  }
+  const uint32_t timeoutMs = MAX_SAMPLES * DT_MS + 2 * WAVE_FIFO_DRAIN_MS;
+
+  while (framesWanted() > 0 && !s_waveAbort) {
+    if ((millis() - start) > timeoutMs) {
+      SerialMon.printf("FIFO acquisition timed out at %u frames\n", s_rawReads);
+      break;
+    }
+    producerWdtReset();
+    if (!fifoDrain()) {
+      SerialMon.println("FIFO read failed — falling back to polled sampling");
+      fifoStop();
+      return false;
     }
+    notifyConsumer();
+    SerialMon.printf("Wave collection (FIFO): %u frames, %d s elapsed\n",
+                     s_rawReads, (millis() - start) / 1000);
+    if (framesWanted() == 0) break;
+
+    // Sleep until the next drain, or just past the last expected frame
+    uint32_t remainingMs = framesWanted() * IMU_DT_MS + IMU_DT_MS;
+    fifoIdle(std::min<uint32_t>(WAVE_FIFO_DRAIN_MS, remainingMs));
   }
+  fifoStop();
 
-  result.nBins = (uint16_t)(binMax - binMin + 1);
-
-  if (m0 <= 0.0) return result;
-
-  // Hs = 4 * sqrt(m0) — standard oceanographic definition
-  result.Hs = 4.0f * sqrtf((float)m0);
-
-  // Parabolic (quadratic) interpolation around peak bin for sub-bin Tp accuracy.
-  // Must use displacement PSD (accelPSD/ω⁴) at adjacent bins — not raw acceleration PSD.
-  // Using acceleration PSD biases the interpolation toward lower bins because 1/ω⁴
-  // grows rapidly toward lower frequencies, skewing the apparent peak shape.
-  float peakFreq = (float)peakBin * df;
-  if (peakBin > binMin && peakBin < binMax) {
-    auto toDispPsd = [&](uint32_t b) -> float {
-      float f = (float)b * df; float w2 = 2.0f * PI * f; w2 *= w2; float w4 = w2 * w2;
-      return (w4 > 0.0f) ? (re[b] * re[b] + fftIm[b] * fftIm[b]) * psdScale / w4 : 0.0f;
-    };
-    float alpha_pk = toDispPsd(peakBin - 1);
-    float beta_pk  = toDispPsd(peakBin);
-    float gamma_pk = toDispPsd(peakBin + 1);
-    float denom = alpha_pk - 2.0f * beta_pk + gamma_pk;
-    if (fabsf(denom) > 1e-30f) {
-      float delta = 0.5f * (alpha_pk - gamma_pk) / denom;
-      peakFreq = ((float)peakBin + delta) * df;
+  if (s_fifoOverflows > 0) {
+    SerialMon.printf("WARNING: FIFO overflowed on %u drains — samples were lost\n", s_fifoOverflows);
+  }
+  return true;
+}
+
+// Polled acquisition: one register read per IMU_DT_MS tick (vTaskDelayUntil, so read
+// time doesn't accumulate as drift) until the window or the budget is used up.
+static void acquirePolled(uint32_t start) {
+  const uint32_t sampleMs = MAX_SAMPLES * DT_MS;
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t tick = 0;
+
+  while ((millis() - start) < sampleMs && framesWanted() > 0 && !s_waveAbort) {
+    if ((tick % (50 * WAVE_DECIMATE)) == 0) {
+      producerWdtReset();
+      SerialMon.printf("Wave collection: %u samples, %d s elapsed\n",
+                       s_rawReads, (millis() - start) / 1000);
     }
+
+    RawAccel r;
+    if (readMPU6500Raw(r)) emitRaw(r);
+    notifyConsumer();
+    tick++;
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(IMU_DT_MS));
   }
-  result.Tp = (peakFreq > 0.0f) ? 1.0f / peakFreq : 0.0f;
-  result.P = 0.49f * result.Hs * result.Hs * result.Tp; // deep-water power proxy
+}
 
-  // Sanity caps (configurable per deployment in config.h)
-  if (result.Hs > WAVE_HS_MAX_M) {
-    result.Hs = 0.0f;
-    result.Tp = 0.0f;  // Clear Tp too — reporting a period without height is inconsistent
+static void acquire(uint32_t start) {
+  s_acqUsedFifo = fifoAvailable && acquireFifo(start);
+  if (!s_acqUsedFifo) acquirePolled(start);
+}
+
+static uint32_t s_acqStart = 0;
+
+static void imuProducerTask(void*) {
+  acquire(s_acqStart);
+  s_producerDone.store(true, std::memory_order_release);
+  notifyConsumer();
+  s_imuTask = NULL;
+  vTaskDelete(NULL);
+}
+
+// Consumer loop: drains the ring until the producer has finished and the ring is empty
+static void consumeRaw() {
+  RawAccel r;
+  for (;;) {
+    while (s_rawRing.pop(r)) consumeFrame(r);
+    if (s_producerDone.load(std::memory_order_acquire)) {
+      while (s_rawRing.pop(r)) consumeFrame(r);  // Frames pushed just before the done flag
+      return;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    esp_task_wdt_reset();
   }
-  if (result.Tp < 0.5f || result.Tp > WAVE_TP_MAX_S) result.Tp = 0.0f;
+}
 
-  return result;
+#if WAVE_ENGINE == WAVE_ENGINE_FFT
+// Sequential (modem-off) collections update the rtcState baseline; concurrent ones
+// are compared against it.
+static void updateModemNoise() {
+  s_oobDb = s_analyzer.bandLevelDb(OOB_FREQ_MIN, OOB_FREQ_MAX);
+  if (s_waveConcurrent) {
+    if (rtcState.waveOobBaselineCount > 0) {
+      s_modemNoiseDb = s_oobDb - rtcState.waveOobBaselineDb;
+    }
+    return;
+  }
+  if (rtcState.waveOobBaselineCount == 0) {
+    rtcState.waveOobBaselineDb = s_oobDb;
+  } else {
+    rtcState.waveOobBaselineDb += OOB_BASELINE_ALPHA * (s_oobDb - rtcState.waveOobBaselineDb);
+  }
+  if (rtcState.waveOobBaselineCount < 255) rtcState.waveOobBaselineCount++;
 }
+#endif
 
-static void ensureIIRInitialized() {
-  if (!iirInitialized) {
-    computeIIRCoeffs(FS_HZ, HP_CUTOFF_HZ, LP_CUTOFF_HZ);
-    iirInitialized = true;
+// Folds this wake's displacement spectrum (after analyze(); zeros if calm) into the
+// rtcState average and takes Hs/Tp from the result.
+static void updateSpectrumAverage(bool calm) {
+  static const float df = (WAVE_FREQ_MAX - WAVE_FREQ_MIN) / (float)WAVE_SPECTRUM_BINS;
+  float psd[WAVE_SPECTRUM_BINS];
+  for (uint32_t i = 0; i < WAVE_SPECTRUM_BINS; i++) {
+    const float fLo = WAVE_FREQ_MIN + (float)i * df;
+    psd[i] = calm ? 0.0f : s_analyzer.displacementPsdMean(fLo, fLo + df);
+    s_spectrum[i] = waveSpectrumEncode(psd[i]);
+  }
+  s_spectrumValid = true;
+
+  const uint32_t now = (uint32_t)time(NULL);
+  const bool timeValid = now >= SECONDS_PER_DAY;
+  if (rtcState.waveSpectrumCount > 0 && timeValid && rtcState.waveSpectrumUtc >= SECONDS_PER_DAY &&
+      now - rtcState.waveSpectrumUtc > WAVE_SPECTRUM_MAX_AGE_S) {
+    SerialMon.printf("Spectrum average: last update %lu min ago, restarting\n",
+                     (unsigned long)((now - rtcState.waveSpectrumUtc) / 60));
+    rtcState.waveSpectrumCount = 0;
   }
+  const float alpha = (rtcState.waveSpectrumCount == 0) ? 1.0f : WAVE_SPECTRUM_ALPHA;
+  waveSpectrumBlend(rtcState.waveSpectrumAvg, psd, alpha);
+  if (rtcState.waveSpectrumCount < 255) rtcState.waveSpectrumCount++;
+  rtcState.waveSpectrumUtc = timeValid ? now : 0;
+
+  WaveSpectrumStats avg = waveSpectrumStats(rtcState.waveSpectrumAvg, WAVE_FREQ_MIN, df);
+  if (avg.Hs > WAVE_HS_MAX_M) avg.Hs = 0.0f;
+  if (avg.Hs == 0.0f || avg.Tp < 0.5f || avg.Tp > WAVE_TP_MAX_S) avg.Tp = 0.0f;
+  s_hsAvg = avg.Hs;
+  s_tpAvg = avg.Tp;
 }
 
-void recordWaveData() {
-  SerialMon.println("=== Starting wave data collection (160s) ===");
+// Collection + analysis; runs on the loop task (recordWaveData) or the wave task
+static void runWaveCollection() {
+  s_settleSamples = SETTLE_SAMPLES;
+#if WAVE_GYRO_ATTITUDE && WAVE_BANDLIMIT_SPECTRAL
+  if (rtcState.gyroBiasValid) s_settleSamples = SETTLE_SAMPLES_WARM;
+#endif
+  s_sampleBudget = WAVE_ADAPTIVE ? MAX_SAMPLES : s_settleSamples + ANALYSIS_SAMPLES;
+  SerialMon.printf("=== Starting wave data collection (%s%.0fs) ===\n",
+                   WAVE_ADAPTIVE ? "up to " : "", s_sampleBudget / FS_HZ);
+
+  // MPU6500 is the only device on the bus and supports 400kHz fast mode
+  Wire.setClock(400000);
 
   if (!imuInitialized) {
     SerialMon.println("Attempting IMU initialization...");
     if (!initMPU6500()) {
       SerialMon.println("ERROR: Failed to initialize IMU; wave data will be zeros");
       s_lastHs = 0.0f; s_lastTp = 0.0f; s_lastWaves = 0;
+      s_lastMoments = {};
+      s_lastHeights = {};
       return;
     } else {
       SerialMon.println("IMU initialized successfully!");
@@ -385,115 +1178,137 @@ void recordWaveData() {
   sampleCount = 0;
   s_heaveAbsSum = 0.0; s_heaveSqSum = 0.0; s_heaveStatCount = 0;
   s_tiltSum = 0.0; s_tiltCount = 0; s_accelRms = 0.0f;
-  hp_y_prev = hp_x_prev = lp_y_prev = 0.0f;
   g_lp_x = 0.0f; g_lp_y = 0.0f; g_lp_z = 9.80665f;
-  iirInitialized = false;
-  ensureIIRInitialized();
-
-  // Collect heave acceleration samples for 160s (1024 FFT + ~57s gravity settling)
-  const uint32_t sampleMs = 160000UL;
-  uint32_t start = millis();
-  uint32_t nextTick = start;
-  uint32_t tick = 0;
-
-  while ((millis() - start) < sampleMs && sampleCount < MAX_SAMPLES) {
-    uint32_t now = millis();
-    if (now < nextTick) { delay(1); continue; }
-    nextTick += DT_MS;
-
-    if ((tick % 50) == 0) {
-      esp_task_wdt_reset();
-      SerialMon.printf("Wave collection: %d samples, %d s elapsed\n",
-                       sampleCount, (now - start) / 1000);
-    }
-
-    float ax = 0, ay = 0, az = 0;
-    readMPU6500(ax, ay, az);
-
-    // Sanity: discard if accel magnitude far from 1g
-    float amag = sqrtf(ax * ax + ay * ay + az * az);
-    if (fabsf(amag - 9.80665f) > 4.9f) { tick++; continue; }
-
-    // Slow gravity tracker in body frame
-    const float dt = 1.0f / FS_HZ;
-    const float RC = 1.0f / (2.0f * PI * G_TRACK_FC_HZ);
-    const float alpha = dt / (RC + dt);
-    g_lp_x = (1.0f - alpha) * g_lp_x + alpha * ax;
-    g_lp_y = (1.0f - alpha) * g_lp_y + alpha * ay;
-    g_lp_z = (1.0f - alpha) * g_lp_z + alpha * az;
-
-    // Specific force (acceleration minus gravity)
-    const float ax_spec = ax - g_lp_x;
-    const float ay_spec = ay - g_lp_y;
-    const float az_spec = az - g_lp_z;
-    float gnorm = sqrtf(g_lp_x * g_lp_x + g_lp_y * g_lp_y + g_lp_z * g_lp_z);
-    if (gnorm < 1e-3f) gnorm = 9.80665f;
-
-    // Tilt: angle between gravity vector and vertical (z-axis)
-    float cosAngle = g_lp_z / gnorm;
-    if (cosAngle > 1.0f) cosAngle = 1.0f;
-    if (cosAngle < -1.0f) cosAngle = -1.0f;
-    s_tiltSum += (double)(acosf(cosAngle) * 57.2958f);
-    s_tiltCount++;
-
-    // Project specific force onto gravity direction to get heave acceleration
-    const float ux = g_lp_x / gnorm, uy = g_lp_y / gnorm, uz = g_lp_z / gnorm;
-    float heaveAcc = -(ax_spec * ux + ay_spec * uy + az_spec * uz);
-    if (fabsf(heaveAcc) < 0.001f) heaveAcc = 0.0f;
-    if (heaveAcc > 5.0f) heaveAcc = 5.0f;
-    else if (heaveAcc < -5.0f) heaveAcc = -5.0f;
-
-    // Light band-limit before storing (anti-alias for FFT)
-    float a_heave = bandLimit(heaveAcc);
-
-    // Store heave acceleration for spectral analysis
-    if (sampleCount < MAX_SAMPLES) {
-      accelBuf[sampleCount] = a_heave;
-      sampleCount++;
-    }
-
-    // Track heave acceleration stats incrementally
-    s_heaveAbsSum += fabsf(a_heave);
-    s_heaveSqSum += (double)a_heave * (double)a_heave;
-    s_heaveStatCount++;
-
-    tick++;
+#if WAVE_GYRO_ATTITUDE
+  attitudeReset();
+#endif
+#if !WAVE_BANDLIMIT_SPECTRAL
+  s_bandFilter.reset();
+#endif
+#if WAVE_DSP_ESPDSP && WAVE_DSP_SELFTEST && WAVE_ENGINE == WAVE_ENGINE_FFT
+  dspCrossCheck();
+#endif
+  s_analyzer.reset();
+  s_oobDb = NAN; s_modemNoiseDb = NAN; s_hsCi = NAN;
+  s_hsAvg = NAN; s_tpAvg = NAN; s_spectrumValid = false;
+  s_lastMoments = {};
+  s_lastHeights = {};
+  s_stopEarly.store(false, std::memory_order_relaxed);
+  s_stopReason = WAVE_ADAPTIVE ? "cap" : "window";
+
+  // Collect heave acceleration for s_sampleBudget frames (160s by default: ~57s gravity
+  // settling + 3 Welch segments; 112.4s with WAVE_GYRO_ATTITUDE):
+  // producer task reads the IMU, this task consumes and analyses as frames arrive.
+  // WAVE_ADAPTIVE: 83s (calm) to WAVE_ADAPTIVE_MAX_S, see adaptiveCheck().
+  const uint32_t start = millis();
+  s_rawReads = 0; s_fifoOverflows = 0; s_fifoDrains = 0;
+  s_ringDrops = 0; s_ringPeak = 0;
+#if WAVE_RAW_CAPTURE
+  s_rawCaptureCount = 0;
+#endif
+  s_rawRing.reset();
+#if WAVE_DECIMATE > 1
+  s_decimator.reset();
+#endif
+  s_producerDone.store(false, std::memory_order_relaxed);
+  s_consumerTask = xTaskGetCurrentTaskHandle();
+  s_acqStart = start;
+  s_inlineConsume = false;
+  const BaseType_t imuCore = (WAVE_IMU_CORE >= 0) ? WAVE_IMU_CORE : 1 - xPortGetCoreID();
+  if (xTaskCreatePinnedToCore(imuProducerTask, "imu", WAVE_IMU_TASK_STACK, NULL,
+                              WAVE_IMU_TASK_PRIORITY, &s_imuTask, imuCore) == pdPASS) {
+    consumeRaw();
+  } else {
+    SerialMon.println("WARNING: Failed to create IMU task — sampling and processing inline");
+    s_imuTask = NULL;
+    s_inlineConsume = true;
+    acquire(start);
   }
 
-  SerialMon.printf("Wave collection complete: %d samples in %d s\n",
-                   sampleCount, (millis() - start) / 1000);
+  SerialMon.printf("Wave collection complete: %d samples, %u Welch segments in %d s (%s)\n",
+                   sampleCount, s_analyzer.segments(), (millis() - start) / 1000, s_stopReason);
+  if (s_acqUsedFifo) {
+    SerialMon.printf("FIFO: %u frames in %u drains, %u overflows\n",
+                     s_rawReads, s_fifoDrains, s_fifoOverflows);
+  }
+  if (!s_inlineConsume) {
+    SerialMon.printf("IMU ring: peak %u/%u frames, %u dropped\n",
+                     s_ringPeak, s_rawRing.capacity(), s_ringDrops);
+  }
 
   // Compute acceleration RMS
   s_accelRms = (s_heaveStatCount > 0)
     ? sqrtf((float)(s_heaveSqSum / (double)s_heaveStatCount))
     : 0.0f;
 
-  // Need at least FFT_N samples for spectral analysis
-  if (sampleCount < FFT_N) {
+  if (s_waveAbort) {
+    SerialMon.println("Wave collection aborted; wave data will be zeros");
+    s_lastHs = 0.0f; s_lastTp = 0.0f; s_lastWaves = 0;
+    return;
+  }
+#if WAVE_GYRO_ATTITUDE
+  attitudeSaveBias();
+#endif
+
+  // Need at least one complete Welch segment for spectral analysis (an adaptive
+  // calm stop may end before the first one)
+  const bool calm = heaveIsCalm();
+  if (s_analyzer.segments() == 0 && !calm) {
     SerialMon.println("Insufficient samples for FFT spectral analysis");
     s_lastHs = 0.0f; s_lastTp = 0.0f; s_lastWaves = 0;
     return;
   }
 
+  if (s_analyzer.segments() > 0) {
+    s_analyzer.finish();
+#if WAVE_ENGINE == WAVE_ENGINE_FFT
+    updateModemNoise();
+#endif
+  }
+
   // Gate on acceleration RMS: skip analysis if essentially no motion
-  float rms_a = s_accelRms;
-  float meanAbsA = (s_heaveStatCount > 0)
-    ? (float)(s_heaveAbsSum / (double)s_heaveStatCount) : 0.0f;
-  if (rms_a < 0.01f && meanAbsA < 0.005f) {
+  if (calm) {
     SerialMon.println("Motion below threshold, reporting calm");
     s_lastHs = 0.0f; s_lastTp = 0.0f; s_lastWaves = 0;
+    updateSpectrumAverage(true);
     return;
   }
 
   // Run FFT spectral analysis
-  SerialMon.println("Running FFT spectral analysis...");
-  SpectralWaveStats ws = spectralAnalysis(accelBuf, sampleCount, FS_HZ);
+  SerialMon.printf("Running spectral analysis (%s engine)...\n",
+                   WAVE_ENGINE == WAVE_ENGINE_FFT ? "FFT" :
+                   WAVE_ENGINE == WAVE_ENGINE_DFTBANK ? "DFT bank" : "Burg AR");
+  SpectralWaveStats ws = s_analyzer.analyze();
+
+  // Sanity caps (configurable per deployment in config.h)
+  if (ws.Hs > WAVE_HS_MAX_M) {
+    ws.Hs = 0.0f;
+    ws.Tp = 0.0f;  // Clear Tp too — reporting a period without height is inconsistent
+  }
+  if (ws.Tp < 0.5f || ws.Tp > WAVE_TP_MAX_S) ws.Tp = 0.0f;
   s_lastHs = ws.Hs;
   s_lastTp = ws.Tp;
   s_lastWaves = ws.nBins; // Report spectral bins used (replaces wave count)
+  if (s_lastHs > 0.0f) s_lastMoments = ws.moments;
+#if WAVE_ZERO_CROSSING
+  if (s_lastHs > 0.0f) s_lastHeights = s_analyzer.waveHeights();
+#endif
+  if (s_lastHs > 0.0f) s_hsCi = s_analyzer.hsConfidence(NULL);
 
-  SerialMon.printf("Spectral result: Hs=%.3f m, Tp=%.2f s, bins=%u\n",
-                   s_lastHs, s_lastTp, s_lastWaves);
+  SerialMon.printf("Spectral result: Hs=%.3f m, Tp=%.2f s (%s), bins=%u\n",
+                   s_lastHs, s_lastTp, ws.tpZoomed ? "zoom" : "parabola", s_lastWaves);
+
+  // A capped (implausible) result would poison the average for hours
+  if (s_lastHs > 0.0f) {
+    updateSpectrumAverage(false);
+    SerialMon.printf("Spectrum average: Hs=%.3f m, Tp=%.2f s over %u wakes\n",
+                     s_hsAvg, s_tpAvg, rtcState.waveSpectrumCount);
+  }
+}
+
+void recordWaveData() {
+  s_waveConcurrent = false;
+  runWaveCollection();
 }
 
 float computeWaveHeight() { return s_lastHs; }
@@ -511,12 +1326,40 @@ float computeAccelRms() { return s_accelRms; }
 
 void logWaveStats() {
   SerialMon.println("---- Wave Stats (FFT spectral) ----");
-  SerialMon.printf("Samples: %u @ %.1f Hz, FFT bins: %u\n",
-                   sampleCount, FS_HZ, s_lastWaves);
-  SerialMon.printf("Hs (sig. height):    %.3f m\n", s_lastHs);
+#if WAVE_ENGINE == WAVE_ENGINE_BURG
+  SerialMon.printf("Samples: %u @ %.1f Hz, AR(%u) record: %u, model grid points: %u\n",
+                   sampleCount, FS_HZ, WAVE_AR_ORDER, s_analyzer.samples(), s_lastWaves);
+#else
+  SerialMon.printf("Samples: %u @ %.1f Hz, Welch segments: %u x %u, FFT bins: %u\n",
+                   sampleCount, FS_HZ, s_analyzer.segments(), FFT_N, s_lastWaves);
+#endif
+#if WAVE_DECIMATE > 1
+  SerialMon.printf("IMU rate:            %.0f Hz, decimated %ux (%u-tap FIR)\n",
+                   IMU_RATE_HZ, WAVE_DECIMATE, s_decimator.TAPS);
+#endif
+  SerialMon.printf("Hs (sig. height):    %.3f m", s_lastHs);
+  if (!isnan(s_hsCi)) SerialMon.printf(" ± %.3f m (95%%)", s_hsCi);
+  SerialMon.println();
+  SerialMon.printf("Window:              %.0f s (%s)\n", getWaveWindowSec(), s_stopReason);
   SerialMon.printf("Tp (period):         %.2f s\n", s_lastTp);
+  if (!isnan(s_hsAvg)) {
+    SerialMon.printf("Average (%3u wakes): Hs %.3f m, Tp %.2f s\n",
+                     rtcState.waveSpectrumCount, s_hsAvg, s_tpAvg);
+  }
   SerialMon.printf("Power proxy:         %.3f kW/m\n",
                    computeWavePower(s_lastHs, s_lastTp));
+  if (s_lastMoments.m0 > 0.0f) {
+    SerialMon.printf("Tm01/Tm02/Te:        %.2f / %.2f / %.2f s\n",
+                     s_lastMoments.tm01(), s_lastMoments.tm02(), s_lastMoments.te());
+    SerialMon.printf("Shape:               nu %.2f, eps %.2f, Qp %.2f\n",
+                     s_lastMoments.narrowness(), s_lastMoments.width(), s_lastMoments.peakedness());
+  }
+#if WAVE_ZERO_CROSSING
+  if (s_lastHeights.waves > 0) {
+    SerialMon.printf("Zero-crossing:       %u waves, Hmax %.3f m, H1/3 %.3f m, Tz %.2f s\n",
+                     s_lastHeights.waves, s_lastHeights.Hmax, s_lastHeights.H13, s_lastHeights.Tz);
+  }
+#endif
 
   const char* seaState = "Unknown";
   if (s_lastHs < 0.02f) seaState = "No waves (Perfect conditions)";
@@ -534,8 +1377,132 @@ void logWaveStats() {
   SerialMon.printf("Accel RMS:           %.4f m/s^2\n", s_accelRms);
   SerialMon.printf("Mean tilt:           %.1f deg\n", computeMeanTilt());
 
+  if (!isnan(s_oobDb)) {
+    SerialMon.printf("Out-of-band noise:   %.1f dB (2-4.5Hz)", s_oobDb);
+    if (!isnan(s_modemNoiseDb)) SerialMon.printf(", %+.1f dB vs modem-off baseline", s_modemNoiseDb);
+    SerialMon.println();
+  }
+
   if (!imuInitialized) {
     SerialMon.println("WARNING: MPU6500 data not available - wave readings may be zero");
   }
   SerialMon.println("----------------------------------");
+
+#if WAVE_RAW_CAPTURE
+  // CSV for host replay; counts are raw MPU6500 registers (±2g, 16384 LSB/g;
+  // gyro ±250 dps, 131 LSB/dps)
+  SerialMon.printf("# PlayBuoy raw IMU capture: fs=%.0fHz, 16384 LSB/g, %lu frames\n",
+                   FS_HZ, (unsigned long)s_rawCaptureCount);
+#if WAVE_GYRO_ATTITUDE
+  SerialMon.println("idx,ax,ay,az,gx,gy,gz");
+#else
+  SerialMon.println("idx,ax,ay,az");
+#endif
+  for (uint32_t i = 0; i < s_rawCaptureCount; i++) {
+    const RawAccel& r = s_rawCapture[i];
+#if WAVE_GYRO_ATTITUDE
+    SerialMon.printf("%lu,%d,%d,%d,%d,%d,%d\n", (unsigned long)i, r.x, r.y, r.z, r.gx, r.gy, r.gz);
+#else
+    SerialMon.printf("%lu,%d,%d,%d\n", (unsigned long)i, r.x, r.y, r.z);
+#endif
+    if ((i & 63) == 63) esp_task_wdt_reset();
+  }
+  SerialMon.println("# end raw IMU capture");
+#endif
+}
+
+// ---- Concurrent collection ----
+
+static void waveTaskMain(void*) {
+  esp_task_wdt_add(NULL);
+  uint32_t t0 = millis();
+  runWaveCollection();
+  s_waveTaskMs = millis() - t0;
+  esp_task_wdt_delete(NULL);
+  s_waveTaskDone = true;
+  s_waveTask = NULL;
+  vTaskDelete(NULL);
+}
+
+bool startWaveCollectionTask() {
+  s_waveConcurrent = true;
+  s_waveTaskDone = false;
+  s_waveAbort = false;
+  s_waveTaskMs = 0;
+  s_concurrentSavedSec = 0.0f;
+  if (xTaskCreatePinnedToCore(waveTaskMain, "wave", WAVE_TASK_STACK, NULL,
+                              WAVE_TASK_PRIORITY, &s_waveTask, WAVE_TASK_CORE) != pdPASS) {
+    SerialMon.println("ERROR: Failed to create wave task");
+    s_waveConcurrent = false;
+    s_waveTask = NULL;
+    return false;
+  }
+  SerialMon.printf("Wave task started on core %d (loop task on core %d)\n",
+                   WAVE_TASK_CORE, xPortGetCoreID());
+  return true;
+}
+
+bool waitWaveCollectionTask(uint32_t timeoutMs) {
+  uint32_t waitStart = millis();
+  while (!s_waveTaskDone && (millis() - waitStart) < timeoutMs) {
+    esp_task_wdt_reset();
+    delay(50);
+  }
+
+  if (!s_waveTaskDone) {
+    SerialMon.println("ERROR: Wave task timed out — aborting");
+    s_waveAbort = true;
+    // Both acquisition loops and the consumer check the flag at least once per drain
+    uint32_t abortStart = millis();
+    while (!s_waveTaskDone && (millis() - abortStart) < 2 * WAVE_FIFO_DRAIN_MS) {
+      esp_task_wdt_reset();
+      delay(50);
+    }
+    if (!s_waveTaskDone) {
+      // Still running after the abort: the producer is stuck inside an I2C transfer.
+      // Deleting it would leave the Wire lock taken for good (Wire.end() takes the
+      // same lock), hanging the next sensor read, so restart instead.
+      SerialMon.println("ERROR: Wave task did not stop after abort — restarting");
+      SerialMon.flush();
+      ESP.restart();
+    }
+    s_lastHs = 0.0f; s_lastTp = 0.0f; s_lastWaves = 0;
+    s_lastMoments = {};
+    s_lastHeights = {};
+    return false;
+  }
+
+  uint32_t waitedMs = millis() - waitStart;
+  s_concurrentSavedSec = (s_waveTaskMs > waitedMs) ? (float)(s_waveTaskMs - waitedMs) / 1000.0f : 0.0f;
+  SerialMon.printf("Wave task done: %u s collection, loop task waited %u s, saved %.0f s awake\n",
+                   s_waveTaskMs / 1000, waitedMs / 1000, s_concurrentSavedSec);
+  return true;
+}
+
+bool waveCollectedConcurrently() { return s_waveConcurrent; }
+float getWaveConcurrentSavedSec() { return s_concurrentSavedSec; }
+float getWaveModemNoiseDb() { return s_modemNoiseDb; }
+
+float getWaveHsCi() { return s_hsCi; }
+float getWaveHsAvg() { return s_hsAvg; }
+
+float getWaveHmax() { return s_lastHeights.Hmax; }
+float getWaveH13() { return s_lastHeights.H13; }
+uint16_t getWaveCount() { return s_lastHeights.waves; }
+
+WaveSpectralParams getWaveSpectralParams() {
+  const SpectralMoments& m = s_lastMoments;
+  return {m.tm01(), m.tm02(), m.te(), m.narrowness(), m.width(), m.peakedness()};
+}
+float getWaveTpAvg() { return s_tpAvg; }
+uint8_t getWaveAvgCount() { return isnan(s_hsAvg) ? 0 : rtcState.waveSpectrumCount; }
+
+String getWaveSpectrumBase64() {
+  if (!s_spectrumValid) return String();
+  uint8_t packed[WAVE_SPECTRUM_PACKED_BYTES];
+  char text[4 * ((WAVE_SPECTRUM_PACKED_BYTES + 2) / 3) + 1];
+  base64Encode(packed, waveSpectrumPack(s_spectrum, WAVE_FREQ_MIN, WAVE_FREQ_MAX, packed), text);
+  return String(text);
 }
+float getWaveWindowSec() { return (float)s_rawReads / IMU_RATE_HZ; }
+uint32_t getWaveWindowMaxSec() { return (uint32_t)(MAX_SAMPLES / FS_HZ); }
@@ -3,21 +3,23 @@
 #include <Arduino.h>
 
 //
-// Wave spectral analysis via FFT (1024-point, 10Hz IMU sampling).
-// Pipeline: acquire 160s accel samples → IIR bandpass filter → FFT → spectral integration.
+// Wave spectral analysis via streaming Welch PSD (512-point segments, 10Hz IMU sampling).
+// Pipeline: acquire 160s accel samples → Butterworth band-pass → Welch FFT per segment → spectral integration.
 // Computes significant wave height (Hs) and peak period (Tp) from displacement spectrum.
 // Replaces legacy time-domain double-integration approach (eliminates drift).
 //
 // ALGORITHM:
 // 1. Raw acceleration measured at 10Hz on MPU6500 Z-axis (vertical)
-// 2. Low-pass filter (highpass + lowpass) to isolate wave motion (0.05-2 Hz passband)
+// 2. Butterworth band-pass (2nd-order HP 0.03 Hz + 4th-order LP 2 Hz, biquad.h) to isolate wave motion
 // 3. Gravity tracking via slow low-pass filter (0.02 Hz) to remove DC offset
-// 4. 1024-point FFT on 102.4s window (last 1024 of 1600 samples; first 57.6s = gravity settling)
+// 4. Welch PSD: 512-point Hann segments, 50% overlap, FFT'd as each fills during sampling
+//    (3 segments over the last 1024 of 1600 samples; first 57.6s = gravity settling)
 // 5. Convert acceleration spectrum to displacement via ω⁴ division (frequency domain)
 // 6. Zero bins below WAVE_FREQ_MIN (0.05 Hz) to prevent low-freq blowup (H-08 fix)
 // 7. Integrate spectrum: m₀ = ∫ PSD df → Hs = 4√m₀ (oceanographic standard)
-// 8. Find peak frequency f_peak via binary search, refine via parabolic interpolation
+// 8. Find peak frequency f_peak, refine via zoomed DTFT around the peak (or parabolic interpolation)
 // 9. Tp = 1 / f_peak (peak period in seconds)
+// WAVE_ENGINE=2 replaces steps 4-8 with a Burg AR model fitted to the last WAVE_AR_SAMPLES (ar_analyzer.h).
 //
 // REFERENCE DOCUMENTS:
 // - IEC 61025:2017 (Wave height statistical definitions)
@@ -26,12 +28,26 @@
 //
 
 //
-// Acquires 160 seconds of heave acceleration samples at 10Hz from IMU.
-// First ~57s discarded (gravity tracker settling); last 1024 samples (102.4s) used for FFT.
-// Performs gravity removal, IIR filtering, and prepares for FFT analysis.
+// Acquires heave acceleration samples at 10Hz from IMU: 160 seconds by default,
+// 112.4s with WAVE_GYRO_ATTITUDE, up to WAVE_ADAPTIVE_MAX_S with WAVE_ADAPTIVE.
+// Default: MPU6500 hardware FIFO drained in bursts every 4s over 400kHz I2C, CPU in
+// light sleep between drains (sample timing from the IMU clock). Falls back to
+// polling one sample per 100ms if the FIFO self-check in IMU init fails.
+// Sampling runs in a high-priority IMU task on the other core from the consumer; it
+// only pushes raw counts into a lock-free SPSC ring (spsc_ring.h), and the calling
+// task consumes them and does all processing, including each Welch FFT as its
+// segment fills.
+// First ~57s discarded (gravity tracker settling; 10s with WAVE_GYRO_ATTITUDE, which
+// shortens the window to 112s); last 1024 samples (102.4s) feed the
+// streaming Welch estimator, which FFTs each 512-sample segment as soon as it fills.
+// WAVE_DECIMATE=R samples the IMU at R·10 Hz and FIR-decimates to 10 Hz in the consumer.
+// Heave is kept as int16 (0.24 mm/s²/LSB) and converted to float per segment.
+// WAVE_RAW_CAPTURE=1 additionally keeps all raw X/Y/Z counts and logWaveStats() dumps them as CSV.
+// Performs gravity removal, IIR filtering (or, with WAVE_BANDLIMIT_SPECTRAL, exact band
+// weights after the FFT), Welch averaging and spectral integration.
 // Updates global s_lastHs, s_lastTp, s_tiltSum, s_accelRms for getter functions.
 // Must be called while 3.3V rail is powered (sensors depend on GPIO 25).
-// Duration: ~160 seconds of active I2C sampling + FFT (<1 second).
+// Duration: the sampling window above (mostly light sleep in FIFO mode) + FFT (<1 second).
 //
 void recordWaveData();
 
@@ -53,6 +69,31 @@ float computeWaveHeight();
 //
 float computeWavePeriod();
 
+//
+// Sea-state parameters from the spectral moments of the last collection, computed
+// in the same pass over the displacement spectrum as Hs (m_n = ∫ fⁿ·S(f) df).
+// All 0 if there was no valid spectrum (calm, capped or failed collection).
+//
+struct WaveSpectralParams {
+  float tm01;   // Mean period m0/m1 (s)
+  float tm02;   // Zero-crossing period Tz = √(m0/m2) (s)
+  float te;     // Energy period m₋₁/m0 (s)
+  float nu;     // Narrowness √(m0·m2/m1² − 1)
+  float eps;    // Width √(1 − m2²/(m0·m4))
+  float qp;     // Goda peakedness 2∫f·S² df / m0²
+};
+WaveSpectralParams getWaveSpectralParams();
+
+//
+// Individual-wave statistics of the last collection (WAVE_ZERO_CROSSING=1, FFT
+// engine): zero-upcrossing analysis of the heave displacement rebuilt by inverse
+// FFT from the Welch segments (the middle 77s of the 102s record).
+// All 0 if unavailable or calm.
+//
+float getWaveHmax();        // Highest wave (m)
+float getWaveH13();         // Mean of the highest third (m), ≈ Hs
+uint16_t getWaveCount();    // Complete waves
+
 //
 // Returns wave direction as cardinal string (N, NE, E, SE, etc.).
 // NOTE: Currently hardcoded to "N/A" because magnetometer is dead
@@ -89,9 +130,85 @@ float computeMeanTilt();
 //
 float computeAccelRms();
 
+//
+// Adaptive window (WAVE_ADAPTIVE=1)
+//
+// Acquisition stops at a Welch hop once the sea is clearly calm (≥83s) or the 95%
+// confidence interval of Hs is tight enough (≥134s), and otherwise continues up to
+// WAVE_ADAPTIVE_MAX_S. The CI comes from the spread of per-segment m0 and is
+// computed for fixed windows too.
+//
+
+// 95% CI half-width of the last Hs (m). NAN if Hs is 0 or fewer than 2 segments finished.
+float getWaveHsCi();
+
+// Length of the last acquisition window (seconds of IMU samples)
+float getWaveWindowSec();
+
+// Longest possible window (160s, or WAVE_ADAPTIVE_MAX_S); for join timeouts
+uint32_t getWaveWindowMaxSec();
+
+//
+// Spectrum average across wakes
+//
+// Each successful (or calm) collection folds its displacement spectrum into a
+// 96-byte log-quantised average kept in rtcState (EWMA, weight WAVE_SPECTRUM_ALPHA;
+// restarted after a gap of WAVE_SPECTRUM_MAX_AGE_S). Short per-wake windows then
+// add up to a stable estimate without longer sensor-on time.
+//
+
+// Hs (m) / Tp (s) of the average after this wake's update. NAN if this wake did not
+// update it (no IMU, aborted, too short or capped).
+float getWaveHsAvg();
+float getWaveTpAvg();
+
+// Wakes folded into the average (saturates at 255); 0 if this wake did not update it
+uint8_t getWaveAvgCount();
+
+// This wake's spectrum as uploaded in wave.spec (WAVE_UPLOAD_SPECTRUM): the same 96
+// log-quantised bins behind a self-describing 8-byte header, base64 (140 chars;
+// format in wave_spectrum.h, decoder in tools/spectrum_decode/). Empty if this
+// wake did not update the average.
+String getWaveSpectrumBase64();
+
 //
 // Logs FFT results and wave statistics to Serial for debugging.
 // Prints: wave height, peak period, peak frequency, spectral moments, etc.
 // Called after recordWaveData() to show what the FFT pipeline computed.
 //
 void logWaveStats();
+
+//
+// Concurrent collection (WAVE_CONCURRENT_MODEM=1)
+//
+// Runs recordWaveData() in a FreeRTOS task pinned to WAVE_TASK_CORE while the loop
+// task brings up the modem and runs NTP/XTRA/GNSS on the other core. The task owns
+// Wire (the IMU is the only I2C device) and uses the FIFO path with vTaskDelay()
+// instead of light sleep, which would halt both cores.
+// The 3.3V rail must stay powered until waitWaveCollectionTask() returns.
+//
+
+// Starts the wave task. Returns false if the task could not be created
+// (caller should fall back to a blocking recordWaveData()).
+bool startWaveCollectionTask();
+
+// Blocks until the wave task has finished, feeding the watchdog. On timeout, asks
+// the task to stop, waits briefly for it and returns false (results are zeros).
+// Restarts the ESP32 if the task is stuck in I2C and does not stop.
+// Records how much of the wave phase overlapped other work (see below).
+bool waitWaveCollectionTask(uint32_t timeoutMs);
+
+// True if the last collection ran in the concurrent task
+bool waveCollectedConcurrently();
+
+// Awake time saved by the last concurrent collection: task duration minus the
+// time the loop task spent blocked in waitWaveCollectionTask() (seconds).
+float getWaveConcurrentSavedSec();
+
+//
+// Out-of-band (2-4.5Hz) heave PSD level of the last collection, minus the modem-off
+// baseline kept in rtcState (EWMA over sequential cycles). Positive = extra sensor
+// noise from modem TX current / supply ripple during concurrent collection.
+// Returns NAN if the last collection was sequential or no baseline exists yet.
+//
+float getWaveModemNoiseDb();
@@ -0,0 +1,654 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <type_traits>
+#include "fft.h"
+#include "dsp.h"
+
+//
+// Streaming Welch wave spectrum: heave acceleration samples in, Hs/Tp and a 95%
+// confidence interval out. Pure C++ (no Arduino dependency); wave.cpp owns the IMU,
+// gravity estimate and band-limiting and pushes settled heave samples into one
+// instance. The same class builds and runs on a host.
+//
+// WaveAnalyzer<N, FS, Opt>: N-point segments (power of 2), 50% overlap, periodic
+// Hann window, sample rate FS Hz. Every buffer is a member sized from N at compile
+// time, so sizeof() is the exact RAM footprint of a configuration; the displacement
+// weights live in flash.
+//
+// Opt (see WaveAnalyzerOptions) sets the wave band, the int16 heave scale, the
+// engine (FFT per segment, or a per-sample DFT bank over the band only), an
+// optional one-pole high-pass response to divide out of the spectrum and the Tp
+// zoom density.
+//
+// Tp zoom (FFT engine, Opt::ZOOM > 0): after each segment's FFT, the segment's
+// DTFT is evaluated directly at ZOOM points per bin over ±ZOOM_SPAN bins around
+// the displacement peak of the first segment, and its displacement power summed
+// like the PSD. analyze() takes Tp from the peak of that averaged fine spectrum
+// instead of a parabola through three bins, as long as the final peak bin lies
+// inside the zoom span (otherwise it keeps the parabola).
+// Weighting a Hann-smeared peak by 1/ω⁴ pulls it low (by ~0.25 bin at bin 6), so
+// the zoom applies 1/ω² to the unwindowed DTFT first and Hann-windows after, as
+// the 3-tap kernel ½X(k) − ¼(X(k−1) + X(k+1)); that leaves ~1/10 of the pull.
+// Like zero padding, zoom cannot separate peaks closer than the window resolution.
+//
+// Wave heights (FFT engine, Opt::WAVE_HEIGHTS): after each segment's PSD, its
+// spectrum is turned into displacement in place (−1/ω² over the band, zero
+// elsewhere) and inverse-FFT'd into the same scratch. The middle half of the
+// segment, divided by the Hann window (≥ 0.5 there), is the displacement for those
+// HOP samples; consecutive segments tile the record from N/4 to N/4 before its
+// end. A zero-upcrossing detector streams over it for Hmax, H1/3 and the wave
+// count. Nothing is integrated in time, so there is no drift to remove.
+//
+// Per collection: reset(), push() each sample, finish(), then analyze().
+//
+
+struct WaveAnalyzerOptions {
+  static constexpr float FREQ_MIN = 0.05f;          // Wave band (Hz); 1/ω⁴ blows up below
+  static constexpr float FREQ_MAX = 1.0f;
+  static constexpr float HEAVE_FULL_SCALE = 8.0f;   // int16 heave history range (m/s²)
+  static constexpr bool DFT_BANK = false;           // false = FFT per segment
+  static constexpr double TRACKER_FC_HZ = 0.0;      // One-pole HP to undo (0 = none)
+  static constexpr uint32_t ZOOM = 0;               // Tp zoom points per bin (0 = off)
+  static constexpr bool WAVE_HEIGHTS = false;       // Zero-upcrossing wave heights (FFT engine)
+};
+
+// Moments m_n = ∫ fⁿ·S(f) df of the wave-band displacement PSD S (f in Hz), and
+// ∫ f·S(f)² df for Goda's peakedness, accumulated in the same pass as m0.
+// The derived parameters return 0 when their moments are empty.
+struct SpectralMoments {
+  float mNeg1;    // m₋₁ (m²·s)
+  float m0;       // m₀ (m²)
+  float m1;       // m₁ (m²/s)
+  float m2;       // m₂ (m²/s²)
+  float m4;       // m₄ (m²/s⁴)
+  float fS2;      // ∫ f·S² df (m⁴)
+
+  float tm01() const { return m1 > 0.0f ? m0 / m1 : 0.0f; }               // Mean period (s)
+  float tm02() const { return m2 > 0.0f ? sqrtf(m0 / m2) : 0.0f; }        // Zero-crossing period Tz (s)
+  float te() const { return m0 > 0.0f ? mNeg1 / m0 : 0.0f; }              // Energy period (s)
+  // Longuet-Higgins narrowness ν = √(m0·m2/m1² − 1)
+  float narrowness() const {
+    return m1 > 0.0f ? sqrtf(std::max(m0 * m2 / (m1 * m1) - 1.0f, 0.0f)) : 0.0f;
+  }
+  // Cartwright/Longuet-Higgins width ε = √(1 − m2²/(m0·m4)); m4 leans on the
+  // high-frequency tail, so this is the noisier of the two
+  float width() const {
+    return m0 * m4 > 0.0f ? sqrtf(std::max(1.0f - m2 * m2 / (m0 * m4), 0.0f)) : 0.0f;
+  }
+  float peakedness() const { return m0 > 0.0f ? 2.0f * fS2 / (m0 * m0) : 0.0f; }  // Goda Qp
+};
+
+// Spectral wave analysis results
+struct SpectralWaveStats {
+  float Hs;       // Significant wave height (m)
+  float Tp;       // Peak period (s)
+  float P;        // Wave power proxy (kW/m)
+  uint16_t nBins; // Number of spectral bins in wave band
+  bool tpZoomed;  // Tp from the zoomed spectrum (else bin parabola)
+  SpectralMoments moments;
+};
+
+// Zero-upcrossing statistics of the reconstructed heave displacement
+struct WaveHeightStats {
+  float Hmax;       // Highest wave, crest to trough (m)
+  float H13;        // Mean of the highest third (m)
+  float Tz;         // Mean zero-upcrossing period (s)
+  uint16_t waves;   // Complete waves
+};
+
+// Acceleration → displacement PSD weight at f > 0 Hz: 1/ω⁴, divided by the
+// tracker high-pass response |H|² when Opt::TRACKER_FC_HZ > 0 (see DispWeights).
+template <typename Opt>
+constexpr double heaveDisplacementWeight(double f, double fs) {
+  const double omega = 2.0 * FFT_PI * f;
+  double w = 1.0 / (omega * omega * omega * omega);
+  if (Opt::TRACKER_FC_HZ > 0.0) {
+    const double dt = 1.0 / fs;
+    const double rc = 1.0 / (2.0 * FFT_PI * Opt::TRACKER_FC_HZ);
+    const double beta = 1.0 - dt / (rc + dt);
+    const double c = constexprCos(omega * dt);
+    w *= (1.0 - 2.0 * beta * c + beta * beta) / (beta * beta * (2.0 - 2.0 * c));
+  }
+  return w;
+}
+
+template <uint32_t N, uint32_t FS, typename Opt = WaveAnalyzerOptions>
+class WaveAnalyzer {
+ public:
+  static_assert(N >= 16 && (N & (N - 1)) == 0, "WaveAnalyzer segment length must be a power of 2");
+
+  static constexpr float FS_HZ = (float)FS;
+  static constexpr uint32_t HOP = N / 2;            // New samples per segment (50% overlap)
+  static constexpr float DF = FS_HZ / (float)N;     // Bin spacing (Hz)
+
+  // Wave band on the bin grid: first bin at or above FREQ_MIN (never DC) up to
+  // FREQ_MAX. 3..51 (0.059-0.996 Hz) for 512 points at 10Hz.
+  static constexpr uint32_t firstBandBin() {
+    uint32_t k = 1;
+    while ((float)k * DF < Opt::FREQ_MIN) k++;
+    return k;
+  }
+  static constexpr uint32_t BAND_BIN_MIN = firstBandBin();
+  static constexpr uint32_t BAND_BIN_MAX =
+      std::min<uint32_t>((uint32_t)(Opt::FREQ_MAX / DF), N / 2);
+  static_assert(BAND_BIN_MIN >= 2 && BAND_BIN_MAX > BAND_BIN_MIN && BAND_BIN_MAX < N / 2,
+                "Wave band must leave a guard bin on each side for the DFT bank's Hann kernel");
+
+  // The DFT bank only ever fills the band
+  static constexpr uint32_t PSD_BINS = Opt::DFT_BANK ? BAND_BIN_MAX + 1 : N / 2 + 1;
+
+  // Heave history resolution: 1 LSB = 0.24 mm/s² at ±8 m/s²; the quantisation noise
+  // (-90 dB re (m/s²)²/Hz) sits ~40 dB below the MPU6500 noise floor.
+  static constexpr float HEAVE_LSB = Opt::HEAVE_FULL_SCALE / 32767.0f;
+
+  typedef RealFft<N> Fft;
+
+  // Displacement weights 1/ω⁴ on the bin grid (flash table, DC weight 0).
+  // Displacement PSD = acceleration PSD · w[k]; m0 = Σ accelPsd[k]·w[k]·df.
+  // With Opt::TRACKER_FC_HZ > 0 the weights also undo a one-pole high-pass
+  // x − LP(x): H(z) = β(1 − z⁻¹)/(1 − βz⁻¹), β = 1 − α,
+  // |H|² = β²(2 − 2cosθ)/(1 − 2βcosθ + β²).
+  struct DispWeights {
+    float w[N / 2 + 1];
+  };
+
+  // Weight at a (fractional) bin position k > 0
+  static constexpr double dispWeight(double k) {
+    return heaveDisplacementWeight<Opt>(k * (double)FS / (double)N, (double)FS);
+  }
+
+  static constexpr DispWeights makeDispWeights() {
+    DispWeights t{};
+    for (uint32_t k = 1; k <= N / 2; k++) t.w[k] = (float)dispWeight((double)k);
+    return t;
+  }
+
+  static constexpr DispWeights weights = makeDispWeights();
+
+  // f⁻¹, f, f², f⁴ at the band bins (flash), so analyze() gets every moment from
+  // the same pass as m0
+  static constexpr uint32_t BAND_BINS = BAND_BIN_MAX - BAND_BIN_MIN + 1;
+  struct MomentWeights {
+    float fInv[BAND_BINS];
+    float f1[BAND_BINS];
+    float f2[BAND_BINS];
+    float f4[BAND_BINS];
+  };
+
+  static constexpr MomentWeights makeMomentWeights() {
+    MomentWeights t{};
+    for (uint32_t i = 0; i < BAND_BINS; i++) {
+      const double f = (double)(BAND_BIN_MIN + i) * (double)FS / (double)N;
+      t.fInv[i] = (float)(1.0 / f);
+      t.f1[i] = (float)f;
+      t.f2[i] = (float)(f * f);
+      t.f4[i] = (float)(f * f * f * f);
+    }
+    return t;
+  }
+
+  static constexpr MomentWeights momentWeights = makeMomentWeights();
+
+  // One-sided PSD(f) = 2 * |X(f)|^2 / (N * fs) * 8/3 for the periodic Hann window
+  // (mean(w^2) = 3/8 exactly). The factor of 2 is also applied to DC and Nyquist;
+  // both lie outside the wave band and are never read.
+  static constexpr float PSD_SCALE = 2.0f / ((float)N * FS_HZ) * (8.0f / 3.0f);
+
+  // Tp zoom grid: ZOOM_POINTS fine bins, 1/ZOOM apart, centred on zoomAnchor_
+  static constexpr uint32_t ZOOM = Opt::ZOOM;
+  static constexpr uint32_t ZOOM_SPAN = 2;
+  static constexpr uint32_t ZOOM_POINTS = ZOOM > 0 ? 2 * ZOOM_SPAN * ZOOM + 1 : 1;
+  static constexpr uint32_t ZOOM_RAW = ZOOM_POINTS + 2 * ZOOM;   // + 1 bin each side for Hann
+  static_assert(ZOOM == 0 || !Opt::DFT_BANK, "Tp zoom needs the FFT engine's sample history");
+
+  // Wave heights: the HEIGHTS_MAX tallest waves are kept (smallest replaced), so
+  // H1/3 is exact up to 3·HEIGHTS_MAX waves (192: over 3 minutes at Tz = 1 s)
+  static constexpr uint32_t HEIGHTS_MAX = Opt::WAVE_HEIGHTS ? 64 : 1;
+  static_assert(!Opt::WAVE_HEIGHTS || !Opt::DFT_BANK, "Wave heights need the FFT engine's segment spectrum");
+
+  // −1/ω² (with tracker correction, see DispWeights) at the band bins (flash)
+  struct HeightGains {
+    float g[BAND_BINS];
+  };
+
+  static constexpr HeightGains makeHeightGains() {
+    HeightGains t{};
+    for (uint32_t i = 0; i < BAND_BINS; i++) {
+      // √ of the power weight; constexpr Newton iteration from 1/ω²
+      const double w = dispWeight((double)(BAND_BIN_MIN + i));
+      const double f = (double)(BAND_BIN_MIN + i) * (double)FS / (double)N;
+      double r = 1.0 / ((2.0 * FFT_PI * f) * (2.0 * FFT_PI * f));
+      for (int it = 0; it < 8; it++) r = 0.5 * (r + w / r);
+      t.g[i] = (float)-r;
+    }
+    return t;
+  }
+
+  static constexpr HeightGains heightGains = makeHeightGains();
+
+  void reset() {
+    memset(psd_, 0, sizeof(psd_));
+    count_ = 0;
+    segments_ = 0;
+    segM0Sum_ = 0.0;
+    segM0SqSum_ = 0.0;
+    memset(zoom_, 0, sizeof(zoom_));
+    zoomAnchor_ = 0;
+    heightCount_ = 0;
+    waveCount_ = 0;
+    zcSamples_ = 0;
+    zcFirst_ = 0;
+    zcLast_ = 0;
+    zcPrev_ = 0.0f;
+    zcMax_ = 0.0f;
+    zcMin_ = 0.0f;
+    zcStarted_ = false;
+  }
+
+  // One settled heave acceleration sample (m/s²). Segments end at N, N + HOP,
+  // N + 2·HOP, ... samples; each is folded into the PSD sum as soon as it ends.
+  void push(float a) {
+    if constexpr (Opt::DFT_BANK) {
+      bankPush(a);
+    } else {
+      fftPush(a);
+    }
+  }
+
+  uint32_t samples() const { return count_; }
+  uint16_t segments() const { return segments_; }
+
+  // 95% CI half-width of Hs = 4√m̄0 from the per-segment m0 spread (Student t, n−1
+  // dof), mapped through the square root. 50% overlapped Hann segments are nearly
+  // independent (correlation ~0.17), so this slightly understates the spread.
+  // hsOut (optional) receives Hs from the mean segment m0.
+  // Returns NAN with fewer than two segments.
+  float hsConfidence(float* hsOut) const {
+    static const float T95[] = {12.706f, 4.303f, 3.182f, 2.776f, 2.571f,
+                                2.447f, 2.365f, 2.306f, 2.262f, 2.228f};
+    const uint32_t n = segments_;
+    if (n == 0) return NAN;
+    const double mean = segM0Sum_ / (double)n;
+    if (hsOut) *hsOut = 4.0f * sqrtf((float)std::max(mean, 0.0));
+    if (n < 2) return NAN;
+    double var = (segM0SqSum_ - (double)n * mean * mean) / (double)(n - 1);
+    if (var < 0.0) var = 0.0;
+    const float t = (n - 1 <= 10) ? T95[n - 2] : 1.96f;
+    const double hw = (double)t * sqrt(var / (double)n);
+    const float hi = 4.0f * sqrtf((float)(mean + hw));
+    const float lo = 4.0f * sqrtf((float)std::max(mean - hw, 0.0));
+    return 0.5f * (hi - lo);
+  }
+
+  // Turns the PSD sum into the average over segments. Call once, after the last push.
+  void finish() {
+    if (segments_ == 0) return;
+    for (uint32_t k = 0; k < PSD_BINS; k++) psd_[k] /= (float)segments_;
+  }
+
+  // Integrates the averaged acceleration PSD into Hs/Tp (no sanity caps). The wave
+  // band of the PSD is converted in place to displacement PSD.
+  SpectralWaveStats analyze() {
+    SpectralWaveStats result = {0.0f, 0.0f, 0.0f, 0, false, {}};
+    const uint32_t binMin = BAND_BIN_MIN;
+    const uint32_t binMax = BAND_BIN_MAX;
+
+    const uint32_t count = BAND_BINS;
+    float* band = psd_ + binMin;
+    const float* w = weights.w + binMin;
+    const MomentWeights& mw = momentWeights;
+
+    // One pass: displacement PSD = acceleration PSD / ω⁴ (in place), every moment
+    // and the peak bin
+    float mNeg1 = 0.0f, m0 = 0.0f, m1 = 0.0f, m2 = 0.0f, m4 = 0.0f, fS2 = 0.0f;
+    float peakPsd = 0.0f;
+    uint32_t peakBin = binMin;
+    for (uint32_t i = 0; i < count; i++) {
+      const float d = band[i] * w[i];
+      band[i] = d;
+      m0 += d;
+      mNeg1 += d * mw.fInv[i];
+      m1 += d * mw.f1[i];
+      m2 += d * mw.f2[i];
+      m4 += d * mw.f4[i];
+      fS2 += d * d * mw.f1[i];
+      if (d > peakPsd) {
+        peakPsd = d;
+        peakBin = binMin + i;
+      }
+    }
+    m0 *= DF;
+    result.moments = {mNeg1 * DF, m0, m1 * DF, m2 * DF, m4 * DF, fS2 * DF};
+
+    result.nBins = (uint16_t)count;
+
+    if (m0 <= 0.0f) return result;
+
+    // Hs = 4 * sqrt(m0) — standard oceanographic definition
+    result.Hs = 4.0f * sqrtf(m0);
+
+    // Parabolic (quadratic) interpolation around peak bin for sub-bin Tp accuracy.
+    // Must use displacement PSD (accelPSD/ω⁴) at adjacent bins — not raw acceleration PSD.
+    // Using acceleration PSD biases the interpolation toward lower bins because 1/ω⁴
+    // grows rapidly toward lower frequencies, skewing the apparent peak shape.
+    float peakFreq = (float)peakBin * DF;
+    if (peakBin > binMin && peakBin < binMax) {
+      float alpha_pk = psd_[peakBin - 1];
+      float beta_pk  = psd_[peakBin];
+      float gamma_pk = psd_[peakBin + 1];
+      float denom = alpha_pk - 2.0f * beta_pk + gamma_pk;
+      if (fabsf(denom) > 1e-30f) {
+        float delta = 0.5f * (alpha_pk - gamma_pk) / denom;
+        peakFreq = ((float)peakBin + delta) * DF;
+      }
+    }
+    if constexpr (ZOOM > 0) {
+      if (zoomAnchor_ > 0 && peakBin > binMin && peakBin < binMax &&
+          peakBin + ZOOM_SPAN > zoomAnchor_ && peakBin < zoomAnchor_ + ZOOM_SPAN) {
+        peakFreq = zoomPeakBin() * DF;
+        result.tpZoomed = true;
+      }
+    }
+    result.Tp = (peakFreq > 0.0f) ? 1.0f / peakFreq : 0.0f;
+    result.P = 0.49f * result.Hs * result.Hs * result.Tp; // deep-water power proxy
+    return result;
+  }
+
+  // Mean averaged-PSD level over [fLo, fHi], dB re (m/s²)²/Hz. FFT engine only
+  // (the DFT bank has no bins outside the wave band).
+  float bandLevelDb(float fLo, float fHi) const {
+    static_assert(!Opt::DFT_BANK, "bandLevelDb needs the full FFT spectrum");
+    const uint32_t kLo = (uint32_t)ceilf(fLo / DF);
+    const uint32_t kHi = std::min<uint32_t>((uint32_t)(fHi / DF), N / 2 - 1);
+    double sum = 0.0;
+    for (uint32_t k = kLo; k <= kHi; k++) sum += psd_[k];
+    return 10.0f * log10f((float)(sum / (double)(kHi - kLo + 1)) + 1e-20f);
+  }
+
+  // Mean displacement PSD over [fLo, fHi] Hz (m²/Hz), after analyze(). Each band
+  // bin k stands for [(k−½)·DF, (k+½)·DF) and is weighted by its overlap, so
+  // resampling onto another grid keeps m0; outside the band counts as zero.
+  float displacementPsdMean(float fLo, float fHi) const {
+    if (fHi <= fLo) return 0.0f;
+    float sum = 0.0f;
+    for (uint32_t k = BAND_BIN_MIN; k <= BAND_BIN_MAX; k++) {
+      const float lo = std::max(fLo, ((float)k - 0.5f) * DF);
+      const float hi = std::min(fHi, ((float)k + 0.5f) * DF);
+      if (hi > lo) sum += psd_[k] * (hi - lo);
+    }
+    return sum / (fHi - fLo);
+  }
+
+  // Zero-upcrossing statistics over the reconstructed displacement (Opt::WAVE_HEIGHTS).
+  // All zero if no complete wave was seen.
+  WaveHeightStats waveHeights() const {
+    WaveHeightStats r = {0.0f, 0.0f, 0.0f, 0};
+    if (waveCount_ == 0) return r;
+    float h[HEIGHTS_MAX];
+    memcpy(h, heights_, heightCount_ * sizeof(float));
+    std::sort(h, h + heightCount_, [](float a, float b) { return a > b; });
+    const uint32_t third = std::min<uint32_t>(std::max<uint32_t>(waveCount_ / 3, 1), heightCount_);
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < third; i++) sum += h[i];
+    r.Hmax = h[0];
+    r.H13 = sum / (float)third;
+    r.Tz = (float)(zcLast_ - zcFirst_) / FS_HZ / (float)waveCount_;
+    r.waves = waveCount_;
+    return r;
+  }
+
+  const float* psd() const { return psd_; }
+
+  // N-float, 16-byte aligned FFT scratch; free to use outside a collection
+  // (between finish() and the next reset()). FFT engine only.
+  float* scratch() {
+    static_assert(!Opt::DFT_BANK, "the DFT bank engine has no segment scratch");
+    return st_.seg;
+  }
+
+ private:
+  // FFT engine: hist is a circular int16 history of the last N heave samples; each
+  // segment is unrolled from it into the float scratch seg and transformed in
+  // place, so overlap needs no extra copy.
+  struct FftState {
+    alignas(16) float seg[N];   // esp-dsp kernels prefer 16-byte alignment
+    int16_t hist[N];
+  };
+
+  // DFT bank engine: segments start every HOP samples and last N, so at most two
+  // overlap; each has running (unwindowed) DFT sums for the band bins plus one guard
+  // bin on either side for the frequency-domain Hann window.
+  static constexpr uint32_t BANK_LO = BAND_BIN_MIN - 1;
+  static constexpr uint32_t BANK_BINS = BAND_BIN_MAX - BAND_BIN_MIN + 3;
+  struct BankSegment {
+    float re[BANK_BINS];
+    float im[BANK_BINS];
+  };
+  struct BankState {
+    BankSegment seg[N / HOP];
+  };
+
+  static inline int16_t quantize(float a) {
+    float q = a / HEAVE_LSB;
+    if (q > 32767.0f) return 32767;
+    if (q < -32767.0f) return -32767;
+    return (int16_t)lroundf(q);
+  }
+
+  // Records a finished segment's band m0 (its own Hs estimate before averaging)
+  void segmentDone(float m0) {
+    segM0Sum_ += m0;
+    segM0SqSum_ += (double)m0 * (double)m0;
+    segments_++;
+  }
+
+  void fftAccumulateSegment() {
+    float* seg = st_.seg;
+    // Remove segment mean (DC offset), then window
+    dspAddConst(seg, N, -dspMean(seg, N));
+    dspMul(seg, Fft::tables.hann, seg, N);
+
+    // Real-input FFT in place: N reals → N/2+1 packed complex bins, no imaginary buffer
+    dspRealFft<N>(seg);
+
+    float m0 = 0.0f;
+    for (uint32_t k = 0; k <= N / 2; k++) {
+      const float p = Fft::binPower(seg, k) * PSD_SCALE;
+      psd_[k] += p;
+      if (k >= BAND_BIN_MIN && k <= BAND_BIN_MAX) m0 += p * weights.w[k];
+    }
+    segmentDone(m0 * DF);
+    if constexpr (Opt::WAVE_HEIGHTS) heightSegment();
+    if constexpr (ZOOM > 0) zoomSegment();
+  }
+
+  // Segment spectrum in seg → displacement (same buffer) → zero-upcrossings over
+  // the middle half
+  void heightSegment() {
+    float* seg = st_.seg;
+    seg[0] = 0.0f;   // DC
+    seg[1] = 0.0f;   // Nyquist
+    for (uint32_t k = 1; k < N / 2; k++) {
+      const float g = (k >= BAND_BIN_MIN && k <= BAND_BIN_MAX) ? heightGains.g[k - BAND_BIN_MIN] : 0.0f;
+      seg[2 * k] *= g;
+      seg[2 * k + 1] *= g;
+    }
+    dspRealIfft<N>(seg);
+    for (uint32_t n = N / 4; n < 3 * N / 4; n++) zeroCrossing(seg[n] / Fft::tables.hann[n]);
+  }
+
+  void zeroCrossing(float z) {
+    if (zcPrev_ < 0.0f && z >= 0.0f) {
+      if (zcStarted_) {
+        recordHeight(zcMax_ - zcMin_);
+        zcLast_ = zcSamples_;
+      } else {
+        zcStarted_ = true;
+        zcFirst_ = zcSamples_;
+        zcLast_ = zcSamples_;
+      }
+      zcMax_ = z;
+      zcMin_ = z;
+    }
+    zcMax_ = std::max(zcMax_, z);
+    zcMin_ = std::min(zcMin_, z);
+    zcPrev_ = z;
+    zcSamples_++;
+  }
+
+  void recordHeight(float h) {
+    if (waveCount_ < 0xFFFF) waveCount_++;
+    if (heightCount_ < HEIGHTS_MAX) {
+      heights_[heightCount_++] = h;
+      return;
+    }
+    uint32_t lo = 0;
+    for (uint32_t i = 1; i < HEIGHTS_MAX; i++) {
+      if (heights_[i] < heights_[lo]) lo = i;
+    }
+    if (h > heights_[lo]) heights_[lo] = h;
+  }
+
+  // Unrolls the newest N samples from hist into seg, converted to m/s²
+  void unrollHistory() {
+    const uint32_t oldest = count_ & (N - 1);
+    for (uint32_t i = 0; i < N; i++) {
+      st_.seg[i] = (float)st_.hist[(oldest + i) & (N - 1)] * HEAVE_LSB;
+    }
+  }
+
+  // Adds this segment's displacement power on the zoom grid. The grid is anchored
+  // on the first segment's displacement peak. The segment is rebuilt from hist
+  // (still intact) and its unwindowed DTFT evaluated with a rotating phasor,
+  // ~8 flops per sample per point, then scaled by 1/ω² and Hann-windowed.
+  void zoomSegment() {
+    if (zoomAnchor_ == 0) {
+      uint32_t k0 = BAND_BIN_MIN;
+      float best = -1.0f;
+      for (uint32_t k = BAND_BIN_MIN; k <= BAND_BIN_MAX; k++) {
+        const float d = psd_[k] * weights.w[k];
+        if (d > best) { best = d; k0 = k; }
+      }
+      zoomAnchor_ = std::max<uint32_t>(std::min<uint32_t>(k0, N / 2 - ZOOM_SPAN - 1), ZOOM_SPAN + 2);
+      for (uint32_t j = 0; j < ZOOM_RAW; j++) {
+        zoomGain_[j] = sqrtf((float)dispWeight((double)zoomBin(j) - 1.0));
+      }
+    }
+
+    float* x = st_.seg;
+    unrollHistory();
+    dspAddConst(x, N, -dspMean(x, N));
+
+    float re[ZOOM_RAW], im[ZOOM_RAW];
+    for (uint32_t j = 0; j < ZOOM_RAW; j++) {
+      const float theta = 2.0f * (float)FFT_PI * (zoomBin(j) - 1.0f) / (float)N;
+      const float c = cosf(theta), sn = sinf(theta);
+      float pr = 1.0f, pi = 0.0f, sr = 0.0f, si = 0.0f;
+      for (uint32_t n = 0; n < N; n++) {
+        sr += x[n] * pr;
+        si -= x[n] * pi;
+        const float t = pr * c - pi * sn;
+        pi = pi * c + pr * sn;
+        pr = t;
+      }
+      re[j] = sr * zoomGain_[j];
+      im[j] = si * zoomGain_[j];
+    }
+    for (uint32_t j = 0; j < ZOOM_POINTS; j++) {
+      const float yr = 0.5f * re[j + ZOOM] - 0.25f * (re[j] + re[j + 2 * ZOOM]);
+      const float yi = 0.5f * im[j + ZOOM] - 0.25f * (im[j] + im[j + 2 * ZOOM]);
+      zoom_[j] += (yr * yr + yi * yi) * PSD_SCALE;
+    }
+  }
+
+  // Fractional bin of zoom point j
+  float zoomBin(uint32_t j) const {
+    return (float)(zoomAnchor_ - ZOOM_SPAN) + (float)j / (float)ZOOM;
+  }
+
+  // Peak of the zoomed displacement spectrum, parabola through the top three points
+  float zoomPeakBin() const {
+    uint32_t jp = 0;
+    for (uint32_t j = 1; j < ZOOM_POINTS; j++) {
+      if (zoom_[j] > zoom_[jp]) jp = j;
+    }
+    float delta = 0.0f;
+    if (jp > 0 && jp + 1 < ZOOM_POINTS) {
+      const float denom = zoom_[jp - 1] - 2.0f * zoom_[jp] + zoom_[jp + 1];
+      if (fabsf(denom) > 1e-30f) delta = 0.5f * (zoom_[jp - 1] - zoom_[jp + 1]) / denom;
+    }
+    return zoomBin(jp) + delta / (float)ZOOM;
+  }
+
+  void fftPush(float a) {
+    st_.hist[count_ & (N - 1)] = quantize(a);
+    count_++;
+    if (count_ < N || ((count_ - N) % HOP) != 0) return;
+
+    unrollHistory();   // oldest → newest
+    fftAccumulateSegment();
+  }
+
+  // Periodic Hann applied in the frequency domain: Xw[k] = ½X[k] − ¼(X[k−1] + X[k+1]).
+  // Only bins 0 and ±1 see a constant offset, so no per-segment mean removal is needed
+  // for the band (k ≥ 2); the result matches the FFT engine to float rounding.
+  void bankFinishSegment(BankSegment& seg) {
+    float m0 = 0.0f;
+    for (uint32_t k = BAND_BIN_MIN; k <= BAND_BIN_MAX; k++) {
+      const uint32_t j = k - BANK_LO;
+      float re = 0.5f * seg.re[j] - 0.25f * (seg.re[j - 1] + seg.re[j + 1]);
+      float im = 0.5f * seg.im[j] - 0.25f * (seg.im[j - 1] + seg.im[j + 1]);
+      const float p = (re * re + im * im) * PSD_SCALE;
+      psd_[k] += p;
+      m0 += p * weights.w[k];
+    }
+    segmentDone(m0 * DF);
+  }
+
+  // Adds sample n of each live segment to its bins: X[k] += x·e^(−j2πkn/N). Twiddles
+  // come from the RealFft cos/sin tables (half period, sign-flipped for the other half).
+  void bankPush(float a) {
+    // Same int16 quantisation as the FFT engine, so both see identical input
+    const float x = (float)quantize(a) * HEAVE_LSB;
+    const uint32_t i = count_++;
+    const uint32_t newest = i / HOP;
+    for (uint32_t s = (newest > 0) ? newest - 1 : 0; s <= newest; s++) {
+      BankSegment& seg = st_.seg[s % (N / HOP)];
+      const uint32_t n = i - s * HOP;
+      if (n == 0) memset(&seg, 0, sizeof(seg));
+      for (uint32_t j = 0; j < BANK_BINS; j++) {
+        const uint32_t idx = ((BANK_LO + j) * n) & (N - 1);
+        float c = Fft::tables.cosTw[idx & (N / 2 - 1)];
+        float sn = Fft::tables.sinTw[idx & (N / 2 - 1)];
+        if (idx >= N / 2) { c = -c; sn = -sn; }
+        seg.re[j] += x * c;
+        seg.im[j] -= x * sn;
+      }
+      if (n == N - 1) bankFinishSegment(seg);
+    }
+  }
+
+  typename std::conditional<Opt::DFT_BANK, BankState, FftState>::type st_;
+  float psd_[PSD_BINS];          // Summed (after finish(): averaged) one-sided acceleration PSD
+  uint32_t count_ = 0;           // Samples pushed since reset()
+  uint16_t segments_ = 0;
+  double segM0Sum_ = 0.0;        // Per-segment band m0, for the Hs confidence interval
+  double segM0SqSum_ = 0.0;
+  float zoom_[ZOOM_POINTS];      // Summed zoomed displacement PSD (ZOOM > 0)
+  float zoomGain_[ZOOM_RAW];     // 1/ω² at each raw DTFT point
+  uint32_t zoomAnchor_ = 0;      // Centre bin of the zoom grid, 0 = not set yet
+  float heights_[HEIGHTS_MAX];   // Tallest waves so far (m), unordered
+  uint32_t heightCount_ = 0;
+  uint16_t waveCount_ = 0;       // All complete waves
+  uint32_t zcSamples_ = 0;       // Displacement samples seen by zeroCrossing()
+  uint32_t zcFirst_ = 0;         // Sample of the first and last upcrossing
+  uint32_t zcLast_ = 0;
+  float zcPrev_ = 0.0f;
+  float zcMax_ = 0.0f;           // Crest and trough of the current wave
+  float zcMin_ = 0.0f;
+  bool zcStarted_ = false;       // First upcrossing seen
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+//
+// Compact wave-band displacement spectrum: WAVE_SPECTRUM_BINS equal bins over the
+// wave band, one byte per bin on a log scale. Small enough for rtcState, where
+// wave.cpp keeps an exponentially weighted average over recent wakes.
+// Pure C++ (no Arduino dependency).
+//
+// Code q = 0 means at or below the floor (and "no energy"); q ≥ 1 stands for
+// WAVE_SPECTRUM_DB_FLOOR + q·WAVE_SPECTRUM_DB_STEP dB re m²/Hz, so -99.5..+27.5 dB
+// (1.1e-10..560 m²/Hz) in 0.5 dB steps: ±6% per bin, well inside the scatter
+// of a single wake's estimate. The sensor noise floor in displacement is ~-70 dB
+// at 1 Hz; a 2 m ocean swell peaks near +15 dB.
+//
+// Averaging is done in linear power and the result re-quantised, so the average
+// only moves by steps of at least ±0.25 dB per update.
+//
+// Upload format (waveSpectrumPack()): an 8-byte header, then one code per bin,
+// base64-encoded for JSON (104 bytes → 140 characters for 96 bins):
+//   0     format version (WAVE_SPECTRUM_FORMAT)
+//   1     bin count
+//   2..3  fMin, mHz (uint16, little-endian); bin i covers fMin + [i, i+1)·df
+//   4..5  fMax, mHz (uint16, little-endian); df = (fMax − fMin) / bin count
+//   6     dB floor (int8, dB re m²/Hz)
+//   7     dB step (uint8, 0.1 dB)
+// The header makes the record self-describing, so a decoder needs no firmware
+// constants (tools/spectrum_decode/ is one).
+//
+
+static constexpr uint32_t WAVE_SPECTRUM_BINS = 96;
+static constexpr float WAVE_SPECTRUM_DB_FLOOR = -100.0f;
+static constexpr float WAVE_SPECTRUM_DB_STEP = 0.5f;
+static constexpr uint8_t WAVE_SPECTRUM_FORMAT = 1;
+static constexpr uint32_t WAVE_SPECTRUM_HEADER_BYTES = 8;
+static constexpr uint32_t WAVE_SPECTRUM_PACKED_BYTES = WAVE_SPECTRUM_HEADER_BYTES + WAVE_SPECTRUM_BINS;
+
+// Displacement PSD (m²/Hz) → code
+inline uint8_t waveSpectrumEncode(float psd) {
+  if (!(psd > 0.0f)) return 0;
+  const float q = (10.0f * log10f(psd) - WAVE_SPECTRUM_DB_FLOOR) / WAVE_SPECTRUM_DB_STEP;
+  if (q < 0.5f) return 0;
+  if (q > 254.5f) return 255;
+  return (uint8_t)lroundf(q);
+}
+
+// Code → displacement PSD (m²/Hz); 0 for code 0
+inline float waveSpectrumDecode(uint8_t q) {
+  if (q == 0) return 0.0f;
+  return powf(10.0f, 0.1f * (WAVE_SPECTRUM_DB_FLOOR + (float)q * WAVE_SPECTRUM_DB_STEP));
+}
+
+// avg ← (1 − alpha)·avg + alpha·psd per bin, in linear power (alpha = 1 replaces)
+inline void waveSpectrumBlend(uint8_t* avg, const float* psd, float alpha) {
+  for (uint32_t i = 0; i < WAVE_SPECTRUM_BINS; i++) {
+    const float old = waveSpectrumDecode(avg[i]);
+    avg[i] = waveSpectrumEncode(old + alpha * (psd[i] - old));
+  }
+}
+
+struct WaveSpectrumStats {
+  float Hs;   // 4√m0 (m)
+  float Tp;   // 1 / peak frequency, parabola through the peak bin (s); 0 if no energy
+};
+
+// Hs/Tp of a compact spectrum whose bin i covers fMin + [i, i+1)·df Hz
+inline WaveSpectrumStats waveSpectrumStats(const uint8_t* q, float fMin, float df) {
+  WaveSpectrumStats s = {0.0f, 0.0f};
+  float m0 = 0.0f, peak = 0.0f;
+  uint32_t peakBin = 0;
+  for (uint32_t i = 0; i < WAVE_SPECTRUM_BINS; i++) {
+    const float p = waveSpectrumDecode(q[i]);
+    m0 += p;
+    if (p > peak) { peak = p; peakBin = i; }
+  }
+  if (peak <= 0.0f) return s;
+  s.Hs = 4.0f * sqrtf(m0 * df);
+
+  float k = (float)peakBin;
+  if (peakBin > 0 && peakBin < WAVE_SPECTRUM_BINS - 1) {
+    const float a = waveSpectrumDecode(q[peakBin - 1]);
+    const float c = waveSpectrumDecode(q[peakBin + 1]);
+    const float denom = a - 2.0f * peak + c;
+    if (fabsf(denom) > 1e-30f) k += 0.5f * (a - c) / denom;
+  }
+  s.Tp = 1.0f / (fMin + (k + 0.5f) * df);
+  return s;
+}
+
+// Header + codes into out[WAVE_SPECTRUM_PACKED_BYTES]; returns the byte count
+inline uint32_t waveSpectrumPack(const uint8_t* q, float fMin, float fMax, uint8_t* out) {
+  const uint16_t lo = (uint16_t)lroundf(fMin * 1000.0f);
+  const uint16_t hi = (uint16_t)lroundf(fMax * 1000.0f);
+  out[0] = WAVE_SPECTRUM_FORMAT;
+  out[1] = (uint8_t)WAVE_SPECTRUM_BINS;
+  out[2] = (uint8_t)(lo & 0xFF);
+  out[3] = (uint8_t)(lo >> 8);
+  out[4] = (uint8_t)(hi & 0xFF);
+  out[5] = (uint8_t)(hi >> 8);
+  out[6] = (uint8_t)(int8_t)lroundf(WAVE_SPECTRUM_DB_FLOOR);
+  out[7] = (uint8_t)lroundf(WAVE_SPECTRUM_DB_STEP * 10.0f);
+  for (uint32_t i = 0; i < WAVE_SPECTRUM_BINS; i++) out[WAVE_SPECTRUM_HEADER_BYTES + i] = q[i];
+  return WAVE_SPECTRUM_PACKED_BYTES;
+}
+
+// Header fields of a packed record
+struct WaveSpectrumHeader {
+  uint8_t version;
+  uint8_t bins;
+  float fMin;     // Hz
+  float fMax;     // Hz
+  float dbFloor;  // dB re m²/Hz
+  float dbStep;   // dB
+};
+
+// Parses a packed record; codes then point into in. False if it is truncated or
+// of an unknown version.
+inline bool waveSpectrumUnpack(const uint8_t* in, uint32_t n, WaveSpectrumHeader* h,
+                               const uint8_t** codes) {
+  if (n < WAVE_SPECTRUM_HEADER_BYTES || in[0] != WAVE_SPECTRUM_FORMAT) return false;
+  h->version = in[0];
+  h->bins = in[1];
+  h->fMin = (float)(in[2] | (in[3] << 8)) / 1000.0f;
+  h->fMax = (float)(in[4] | (in[5] << 8)) / 1000.0f;
+  h->dbFloor = (float)(int8_t)in[6];
+  h->dbStep = (float)in[7] / 10.0f;
+  if (h->bins == 0 || n < WAVE_SPECTRUM_HEADER_BYTES + h->bins || h->fMax <= h->fMin) return false;
+  *codes = in + WAVE_SPECTRUM_HEADER_BYTES;
+  return true;
+}
+
+// Standard base64 (RFC 4648, with padding) of n bytes; out needs 4·⌈n/3⌉ + 1 chars.
+// Returns the length without the terminating NUL.
+inline uint32_t base64Encode(const uint8_t* in, uint32_t n, char* out) {
+  static const char ALPHABET[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  uint32_t o = 0;
+  for (uint32_t i = 0; i < n; i += 3) {
+    const uint32_t v = ((uint32_t)in[i] << 16) |
+                       (i + 1 < n ? (uint32_t)in[i + 1] << 8 : 0) |
+                       (i + 2 < n ? (uint32_t)in[i + 2] : 0);
+    out[o++] = ALPHABET[(v >> 18) & 63];
+    out[o++] = ALPHABET[(v >> 12) & 63];
+    out[o++] = (i + 1 < n) ? ALPHABET[(v >> 6) & 63] : '=';
+    out[o++] = (i + 2 < n) ? ALPHABET[v & 63] : '=';
+  }
+  out[o] = '\0';
+  return o;
+}
+
+// Decodes base64 (padding optional, no whitespace) into out[0..max). Returns the
+// byte count, or -1 on an invalid character or if out is too small.
+inline int32_t base64Decode(const char* in, uint8_t* out, uint32_t max) {
+  uint32_t acc = 0, bits = 0, o = 0;
+  for (; *in && *in != '='; in++) {
+    const char c = *in;
+    int32_t v;
+    if (c >= 'A' && c <= 'Z') v = c - 'A';
+    else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+    else if (c >= '0' && c <= '9') v = c - '0' + 52;
+    else if (c == '+') v = 62;
+    else if (c == '/') v = 63;
+    else return -1;
+    acc = (acc << 6) | (uint32_t)v;
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      if (o >= max) return -1;
+      out[o++] = (uint8_t)(acc >> bits);
+    }
+  }
+  return (int32_t)o;
+}
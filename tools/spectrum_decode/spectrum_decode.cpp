@@ -0,0 +1,83 @@
+//
+// Host decoder for the wave.spec upload field (WAVE_UPLOAD_SPECTRUM).
+//
+// Decodes the base64 record described in src/wave_spectrum.h and prints one line
+// per bin (centre frequency in Hz, displacement PSD in m²/Hz), followed by m0,
+// Hs = 4√m0, Tp (parabola through the peak bin, as on the buoy) and the mean
+// periods Tm01 = m0/m1 and Tm02 = √(m0/m2), all recomputed from the bins (code 0
+// counts as zero energy).
+//
+// Build (from the repo root):
+//   g++ -std=c++17 -O2 -Isrc tools/spectrum_decode/spectrum_decode.cpp -o spectrum_decode
+// Usage:
+//   ./spectrum_decode <base64>        (or the base64 text on stdin)
+//   ./spectrum_decode --csv <base64>  (CSV rows only: f_hz,psd_m2_per_hz)
+//
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "wave_spectrum.h"
+
+int main(int argc, char** argv) {
+  bool csv = false;
+  std::string text;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) csv = true;
+    else text = argv[i];
+  }
+  if (text.empty()) std::getline(std::cin, text);
+  // Tolerate the value pasted with its JSON quotes or trailing whitespace
+  while (!text.empty() && (text.back() == '"' || isspace((unsigned char)text.back()))) text.pop_back();
+  while (!text.empty() && (text.front() == '"' || isspace((unsigned char)text.front()))) text.erase(0, 1);
+
+  std::vector<uint8_t> bytes(text.size());
+  const int32_t n = base64Decode(text.c_str(), bytes.data(), (uint32_t)bytes.size());
+  if (n < 0) {
+    fprintf(stderr, "spectrum_decode: invalid base64\n");
+    return 1;
+  }
+  WaveSpectrumHeader h;
+  const uint8_t* codes = nullptr;
+  if (!waveSpectrumUnpack(bytes.data(), (uint32_t)n, &h, &codes)) {
+    fprintf(stderr, "spectrum_decode: not a version %u wave spectrum record (%d bytes)\n",
+            WAVE_SPECTRUM_FORMAT, n);
+    return 1;
+  }
+
+  const double df = (double)(h.fMax - h.fMin) / h.bins;
+  std::vector<double> psd(h.bins);
+  double m0 = 0.0, m1 = 0.0, m2 = 0.0, peak = 0.0;
+  uint32_t peakBin = 0;
+  if (csv) printf("f_hz,psd_m2_per_hz\n");
+  else printf("# %u bins, %.3f-%.3f Hz (df %.5f Hz), %.1f dB + %.1f dB/code\n",
+              h.bins, h.fMin, h.fMax, df, h.dbFloor, h.dbStep);
+  for (uint32_t i = 0; i < h.bins; i++) {
+    const double f = h.fMin + (i + 0.5) * df;
+    const double s = codes[i] ? pow(10.0, 0.1 * (h.dbFloor + codes[i] * h.dbStep)) : 0.0;
+    psd[i] = s;
+    printf(csv ? "%.5f,%.6g\n" : "%8.5f  %.6g\n", f, s);
+    m0 += s * df;
+    m1 += s * f * df;
+    m2 += s * f * f * df;
+    if (s > peak) { peak = s; peakBin = i; }
+  }
+  if (csv) return 0;
+
+  printf("# m0 %.6g m², Hs %.3f m", m0, 4.0 * sqrt(m0));
+  if (peak > 0.0) {
+    // Parabola through the peak bin, as waveSpectrumStats() on the buoy
+    double k = peakBin;
+    if (peakBin > 0 && peakBin + 1 < h.bins) {
+      const double denom = psd[peakBin - 1] - 2.0 * peak + psd[peakBin + 1];
+      if (fabs(denom) > 1e-30) k += 0.5 * (psd[peakBin - 1] - psd[peakBin + 1]) / denom;
+    }
+    printf(", Tp %.2f s, Tm01 %.2f s, Tm02 %.2f s",
+           1.0 / (h.fMin + (k + 0.5) * df), m0 / m1, sqrt(m0 / m2));
+  }
+  printf("\n");
+  return 0;
+}
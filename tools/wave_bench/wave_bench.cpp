@@ -0,0 +1,918 @@
+//
+// Host benchmarks for the wave spectral engines (src/wave_analyzer.h and friends)
+// on synthetic JONSWAP heave records.
+//
+// Each section synthesises heave acceleration at 10 Hz from a JONSWAP displacement
+// spectrum (random phases, Rayleigh amplitudes, white sensor noise), runs it through
+// the engine under test, prints the numbers and ends with PASS/FAIL checks. The
+// exit status is 1 if any check failed. Timings are host CPU time and only
+// meaningful relative to each other.
+//
+//   welch   streaming Welch (3 × 512-point segments) vs the former single 1024-point
+//           periodogram: Hs/Tp spread over many records and peak memory
+//   fft     RealFft<N> vs the former complex fftInPlace(): error against a double
+//           DFT, inverse round trip, time per window + FFT
+//   dsp     dsp.h backends: a host port of the esp-dsp ANSI radix-2 kernel behind
+//           RealFft::split/merge (the esp-dsp path of dspRealFft/dspRealIfft) vs the
+//           portable path, and the vector kernels vs double loops
+//   bank    DFT bank engine vs the FFT engine: CPU per sample, memory, Hs/Tp
+//           agreement (recorded traces: tools/wave_replay runs both on a capture)
+//   sos     Butterworth band-pass (biquad.h) as wave.cpp builds it: gain measured
+//           by running sines through SosFilter vs sosGainSq() and the closed form,
+//           with the former first-order RC pair for reference
+//   zoom    Tp zoom (ZOOM = 8) vs the bin parabola on tones and non-Rayleigh JONSWAP
+//           records: Tp error, CPU per record, and against zero-padding every
+//           segment to a 4096-point FFT for the same grid
+//   burg    Burg AR(24) engine (ar_analyzer.h) vs record length 30-102 s: Hs/Tp
+//           error, next to streaming Welch wherever a 512-point segment fits
+//
+// Build (from the repo root):
+//   g++ -std=c++17 -O2 -Isrc tools/wave_bench/wave_bench.cpp src/dsp.cpp -o wave_bench
+// Usage:
+//   ./wave_bench            (every section)
+//   ./wave_bench <section>...
+//
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "fft.h"
+#include "dsp.h"
+#include "wave_analyzer.h"
+#include "biquad.h"
+#include "ar_analyzer.h"
+
+static constexpr uint32_t FS = 10;                 // Analysis sample rate (Hz), as in wave.cpp
+static constexpr float FS_HZ = (float)FS;
+static constexpr double SENSOR_NOISE = 0.005;      // White heave noise (m/s² rms), MPU6500 at 10 Hz
+static constexpr uint32_t RECORD = 1024;           // Analysed samples per collection (after settling)
+
+// ---- Synthetic sea ----
+
+struct Sea {
+  double hs;      // Significant height 4√m0 over all frequencies (m)
+  double tp;      // Peak period (s)
+  double gamma;   // JONSWAP peak enhancement (1 = Pierson-Moskowitz)
+};
+
+// xorshift32 + Box-Muller, so records are the same with any standard library
+struct Rng {
+  uint32_t s;
+  explicit Rng(uint32_t seed) : s(seed * 2654435761u + 1u) {}
+  double uniform() {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return ((double)s + 0.5) / 4294967296.0;
+  }
+  double normal() {
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * FFT_PI * uniform());
+  }
+};
+
+static constexpr double SYNTH_F_MIN = 0.02;
+static constexpr double SYNTH_F_MAX = 3.0;
+static constexpr double SYNTH_DF = 0.002;   // 500 s repeat period, well beyond any record
+
+static double jonswapShape(const Sea& sea, double f) {
+  const double fp = 1.0 / sea.tp;
+  const double sigma = (f <= fp) ? 0.07 : 0.09;
+  const double r = exp(-(f - fp) * (f - fp) / (2.0 * sigma * sigma * fp * fp));
+  return pow(f, -5.0) * exp(-1.25 * pow(fp / f, 4.0)) * pow(sea.gamma, r);
+}
+
+// Scale from jonswapShape() to displacement PSD (m²/Hz) so the synthesised
+// components add up to sea.hs
+static double jonswapScale(const Sea& sea) {
+  double m0 = 0.0;
+  for (uint32_t i = 0; SYNTH_F_MIN + i * SYNTH_DF < SYNTH_F_MAX; i++) {
+    m0 += jonswapShape(sea, SYNTH_F_MIN + i * SYNTH_DF) * SYNTH_DF;
+  }
+  return sea.hs * sea.hs / (16.0 * m0);
+}
+
+// Expected Hs over [fLo, fHi] (what the analyzers integrate)
+static double bandHs(const Sea& sea, double fLo, double fHi) {
+  const double scale = jonswapScale(sea);
+  double m0 = 0.0;
+  for (uint32_t i = 0; SYNTH_F_MIN + i * SYNTH_DF < SYNTH_F_MAX; i++) {
+    const double f = SYNTH_F_MIN + i * SYNTH_DF;
+    if (f >= fLo && f <= fHi) m0 += jonswapShape(sea, f) * scale * SYNTH_DF;
+  }
+  return 4.0 * sqrt(m0);
+}
+
+// n samples of heave acceleration (m/s²). rayleigh = false gives every component
+// its expected amplitude (random phase only), for peak-position tests.
+static std::vector<float> jonswapHeave(const Sea& sea, uint32_t n, uint32_t seed,
+                                       bool rayleigh = true, double noise = SENSOR_NOISE) {
+  Rng rng(seed);
+  const double scale = jonswapScale(sea);
+  std::vector<double> acc(n, 0.0);
+  for (uint32_t c = 0; SYNTH_F_MIN + c * SYNTH_DF < SYNTH_F_MAX; c++) {
+    const double f = SYNTH_F_MIN + c * SYNTH_DF;
+    const double w = 2.0 * FFT_PI * f;
+    const double var = jonswapShape(sea, f) * scale * SYNTH_DF;
+    double a, b;   // η = a·cos ωt + b·sin ωt
+    if (rayleigh) {
+      a = sqrt(var) * rng.normal();
+      b = sqrt(var) * rng.normal();
+    } else {
+      const double ph = 2.0 * FFT_PI * rng.uniform();
+      a = sqrt(2.0 * var) * cos(ph);
+      b = sqrt(2.0 * var) * sin(ph);
+    }
+    // Rotating phasor instead of cos/sin per sample; ä = −ω²η
+    const double cr = cos(w / FS), ci = sin(w / FS);
+    double zr = 1.0, zi = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+      acc[i] -= w * w * (a * zr + b * zi);
+      const double t = zr * cr - zi * ci;
+      zi = zr * ci + zi * cr;
+      zr = t;
+    }
+  }
+  std::vector<float> out(n);
+  for (uint32_t i = 0; i < n; i++) out[i] = (float)(acc[i] + noise * rng.normal());
+  return out;
+}
+
+// ---- Reporting ----
+
+static int g_failed = 0;
+
+static void check(bool ok, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void check(bool ok, const char* fmt, ...) {
+  printf("  %s  ", ok ? "PASS" : "FAIL");
+  va_list ap;
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+  printf("\n");
+  if (!ok) g_failed++;
+}
+
+// Mean and standard deviation of a sample
+struct Spread {
+  double sum = 0.0, sq = 0.0;
+  uint32_t n = 0;
+  void add(double x) { sum += x; sq += x * x; n++; }
+  double mean() const { return n ? sum / n : 0.0; }
+  double std() const { return n > 1 ? sqrt(std::max(0.0, (sq - sum * sum / n) / (n - 1))) : 0.0; }
+  double rms() const { return n ? sqrt(sq / n) : 0.0; }
+};
+
+static double nowUs() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile float g_sink;   // Keeps timed results alive
+
+template <typename A>
+static SpectralWaveStats runAnalyzer(A& an, const std::vector<float>& x) {
+  an.reset();
+  for (float a : x) an.push(a);
+  an.finish();
+  return an.analyze();
+}
+
+// ---- welch: streaming Welch vs the former single-window periodogram ----
+
+// The pre-Welch path, kept verbatim in behaviour: one 1024-point periodogram of the
+// last 1024 samples of a 1600-float record buffer, symmetric Hann window, complex
+// radix-2 FFT with a zero imaginary buffer, PSD/ω⁴ band sum, parabola on the peak.
+namespace legacy {
+
+static constexpr uint32_t FFT_N = 1024;
+static constexpr uint32_t MAX_SAMPLES = 1600;
+static constexpr float PI_F = 3.14159265358979f;
+static float accelBuf[MAX_SAMPLES];
+static float fftIm[FFT_N];
+static constexpr size_t PEAK_BYTES = sizeof(accelBuf) + sizeof(fftIm);
+
+static void fftInPlace(float* re, float* im, uint32_t n) {
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < n - 1; i++) {
+    if (i < j) {
+      float tr = re[i]; re[i] = re[j]; re[j] = tr;
+      float ti = im[i]; im[i] = im[j]; im[j] = ti;
+    }
+    uint32_t k = n >> 1;
+    while (k <= j) { j -= k; k >>= 1; }
+    j += k;
+  }
+  for (uint32_t len = 2; len <= n; len <<= 1) {
+    float angle = -2.0f * PI_F / (float)len;
+    float wr = cosf(angle), wi = sinf(angle);
+    for (uint32_t i = 0; i < n; i += len) {
+      float wr_k = 1.0f, wi_k = 0.0f;
+      for (uint32_t k = 0; k < len / 2; k++) {
+        uint32_t u = i + k, v = i + k + len / 2;
+        float tr = wr_k * re[v] - wi_k * im[v];
+        float ti = wr_k * im[v] + wi_k * re[v];
+        re[v] = re[u] - tr;
+        im[v] = im[u] - ti;
+        re[u] += tr;
+        im[u] += ti;
+        float new_wr = wr_k * wr - wi_k * wi;
+        wi_k = wr_k * wi + wi_k * wr;
+        wr_k = new_wr;
+      }
+    }
+  }
+}
+
+static SpectralWaveStats spectralAnalysis(const std::vector<float>& x) {
+  SpectralWaveStats result = {0.0f, 0.0f, 0.0f, 0, false, {}};
+  if (x.size() < FFT_N) return result;
+  float* re = accelBuf;
+  memcpy(re, x.data() + (x.size() - FFT_N), FFT_N * sizeof(float));
+
+  double mean = 0.0;
+  for (uint32_t i = 0; i < FFT_N; i++) mean += re[i];
+  mean /= (double)FFT_N;
+  for (uint32_t i = 0; i < FFT_N; i++) re[i] -= (float)mean;
+  for (uint32_t i = 0; i < FFT_N; i++) {
+    re[i] *= 0.5f * (1.0f - cosf(2.0f * PI_F * (float)i / (float)(FFT_N - 1)));
+  }
+  memset(fftIm, 0, sizeof(fftIm));
+  fftInPlace(re, fftIm, FFT_N);
+
+  const float df = FS_HZ / (float)FFT_N;
+  const float psdScale = 2.0f / ((float)FFT_N * FS_HZ) * (8.0f / 3.0f);
+  uint32_t binMin = (uint32_t)(WaveAnalyzerOptions::FREQ_MIN / df);
+  uint32_t binMax = (uint32_t)(WaveAnalyzerOptions::FREQ_MAX / df);
+  if (binMin < 1) binMin = 1;
+  auto dispPsd = [&](uint32_t k) {
+    const float w = 2.0f * PI_F * (float)k * df;
+    return (re[k] * re[k] + fftIm[k] * fftIm[k]) * psdScale / (w * w * w * w);
+  };
+  double m0 = 0.0;
+  float peakPsd = 0.0f;
+  uint32_t peakBin = binMin;
+  for (uint32_t k = binMin; k <= binMax; k++) {
+    if ((float)k * df < WaveAnalyzerOptions::FREQ_MIN) continue;
+    const float d = dispPsd(k);
+    m0 += (double)d * df;
+    if (d > peakPsd) { peakPsd = d; peakBin = k; }
+  }
+  result.nBins = (uint16_t)(binMax - binMin + 1);
+  if (m0 <= 0.0) return result;
+  result.Hs = 4.0f * sqrtf((float)m0);
+  float peakFreq = (float)peakBin * df;
+  if (peakBin > binMin && peakBin < binMax) {
+    const float a = dispPsd(peakBin - 1), b = dispPsd(peakBin), c = dispPsd(peakBin + 1);
+    const float denom = a - 2.0f * b + c;
+    if (fabsf(denom) > 1e-30f) peakFreq = ((float)peakBin + 0.5f * (a - c) / denom) * df;
+  }
+  result.Tp = (peakFreq > 0.0f) ? 1.0f / peakFreq : 0.0f;
+  return result;
+}
+
+}  // namespace legacy
+
+typedef WaveAnalyzer<512, FS> WelchAnalyzer;
+
+static void benchWelch() {
+  static const Sea SEAS[] = {{0.15, 2.0, 3.3}, {0.30, 3.0, 3.3}, {0.50, 4.5, 3.3}};
+  static const uint32_t TRIALS = 200;
+  static WelchAnalyzer welch;
+
+  printf("Streaming Welch (3 x 512, 50%% overlap) vs single 1024-point periodogram, %u records each\n",
+         TRIALS);
+  printf("  %-22s %-10s %12s %12s %12s %12s\n", "sea", "path", "Hs bias", "Hs std", "Tp bias", "Tp std");
+  bool lowerSpread = true, unbiased = true;
+  for (const Sea& sea : SEAS) {
+    const double hsRef = bandHs(sea, WaveAnalyzerOptions::FREQ_MIN, WaveAnalyzerOptions::FREQ_MAX);
+    Spread hsW, tpW, hsL, tpL;
+    for (uint32_t t = 0; t < TRIALS; t++) {
+      const std::vector<float> x = jonswapHeave(sea, RECORD, 1000 + t);
+      const SpectralWaveStats w = runAnalyzer(welch, x);
+      const SpectralWaveStats l = legacy::spectralAnalysis(x);
+      hsW.add(w.Hs / hsRef - 1.0);
+      tpW.add(w.Tp / sea.tp - 1.0);
+      hsL.add(l.Hs / hsRef - 1.0);
+      tpL.add(l.Tp / sea.tp - 1.0);
+    }
+    char label[32];
+    snprintf(label, sizeof(label), "Hs %.2f m, Tp %.1f s", sea.hs, sea.tp);
+    printf("  %-22s %-10s %+11.1f%% %11.1f%% %+11.1f%% %11.1f%%\n", label, "Welch",
+           100 * hsW.mean(), 100 * hsW.std(), 100 * tpW.mean(), 100 * tpW.std());
+    printf("  %-22s %-10s %+11.1f%% %11.1f%% %+11.1f%% %11.1f%%\n", "", "1024-pt",
+           100 * hsL.mean(), 100 * hsL.std(), 100 * tpL.mean(), 100 * tpL.std());
+    lowerSpread = lowerSpread && hsW.std() < hsL.std() && tpW.std() < tpL.std();
+    unbiased = unbiased && fabs(hsW.mean()) < 0.05;
+  }
+
+  const size_t welchBytes = sizeof(WelchAnalyzer);
+  printf("  Peak memory: Welch analyzer %zu B, former record buffer + fftIm %zu B\n",
+         welchBytes, legacy::PEAK_BYTES);
+  check(lowerSpread, "Welch Hs and Tp spread below the single periodogram's for every sea");
+  check(unbiased, "Welch Hs bias within 5%% of the band Hs");
+  check(welchBytes < legacy::PEAK_BYTES / 2, "Welch state under half the former peak memory");
+}
+
+// ---- fft: RealFft<N> vs fftInPlace() ----
+
+// Max |X − X_ref| over the N/2+1 bins, relative to max |X_ref|; X_ref is a double
+// DFT of the same float input
+struct FftError {
+  double maxRef = 0.0, maxErr = 0.0;
+  void add(double re, double im, double refRe, double refIm) {
+    maxRef = std::max(maxRef, hypot(refRe, refIm));
+    maxErr = std::max(maxErr, hypot(re - refRe, im - refIm));
+  }
+  double rel() const { return maxRef > 0.0 ? maxErr / maxRef : 0.0; }
+};
+
+template <uint32_t N>
+static bool benchFftSize(uint32_t iters) {
+  typedef RealFft<N> Fft;
+  const std::vector<float> x = jonswapHeave({0.3, 3.0, 3.3}, N, 7);
+
+  std::vector<double> refRe(N / 2 + 1), refIm(N / 2 + 1);
+  for (uint32_t k = 0; k <= N / 2; k++) {
+    double re = 0.0, im = 0.0;
+    for (uint32_t i = 0; i < N; i++) {
+      const double a = 2.0 * FFT_PI * (double)((uint64_t)k * i % N) / (double)N;
+      re += x[i] * cos(a);
+      im -= x[i] * sin(a);
+    }
+    refRe[k] = re;
+    refIm[k] = im;
+  }
+
+  static float buf[N], re[N], im[N];
+  memcpy(buf, x.data(), sizeof(buf));
+  Fft::forward(buf);
+  FftError realErr;
+  for (uint32_t k = 0; k <= N / 2; k++) {
+    const double bre = (k == 0) ? buf[0] : (k == N / 2) ? buf[1] : buf[2 * k];
+    const double bim = (k == 0 || k == N / 2) ? 0.0 : buf[2 * k + 1];
+    realErr.add(bre, bim, refRe[k], refIm[k]);
+  }
+  Fft::inverse(buf);
+  double roundTrip = 0.0, peak = 0.0;
+  for (uint32_t i = 0; i < N; i++) {
+    roundTrip = std::max(roundTrip, (double)fabsf(buf[i] - x[i]));
+    peak = std::max(peak, (double)fabsf(x[i]));
+  }
+
+  memcpy(re, x.data(), sizeof(re));
+  memset(im, 0, sizeof(im));
+  legacy::fftInPlace(re, im, N);
+  FftError legacyErr;
+  for (uint32_t k = 0; k <= N / 2; k++) legacyErr.add(re[k], im[k], refRe[k], refIm[k]);
+
+  // Window + FFT as each path runs it per segment: cosf() Hann and a zeroed
+  // imaginary buffer before, the flash Hann table and no imaginary buffer now
+  double t0 = nowUs();
+  for (uint32_t it = 0; it < iters; it++) {
+    for (uint32_t i = 0; i < N; i++) {
+      re[i] = x[i] * 0.5f * (1.0f - cosf(2.0f * legacy::PI_F * (float)i / (float)(N - 1)));
+    }
+    memset(im, 0, sizeof(im));
+    legacy::fftInPlace(re, im, N);
+    g_sink = re[it % N];
+  }
+  double t1 = nowUs();
+  for (uint32_t it = 0; it < iters; it++) {
+    for (uint32_t i = 0; i < N; i++) buf[i] = x[i] * Fft::tables.hann[i];
+    Fft::forward(buf);
+    g_sink = buf[it % N];
+  }
+  double t2 = nowUs();
+  const double legacyUs = (t1 - t0) / iters, realUs = (t2 - t1) / iters;
+
+  printf("  N=%-5u max rel err: RealFft %.1e, fftInPlace %.1e; round trip %.1e of peak\n",
+         N, realErr.rel(), legacyErr.rel(), roundTrip / peak);
+  printf("          window + FFT: RealFft %.2f us, fftInPlace %.2f us (%.1fx); RAM %zu B vs %zu B\n",
+         realUs, legacyUs, legacyUs / realUs, sizeof(float) * N, 2 * sizeof(float) * N);
+  check(realErr.rel() < 1e-6, "N=%u RealFft within 1e-6 of the double DFT", N);
+  check(realErr.rel() <= legacyErr.rel(), "N=%u RealFft no less accurate than fftInPlace", N);
+  check(roundTrip < 1e-6 * peak, "N=%u inverse(forward(x)) = x within 1e-6", N);
+  return realUs < legacyUs;
+}
+
+static void benchFft() {
+  printf("Real-input FFT with flash tables vs complex fftInPlace(), JONSWAP record input\n");
+  const bool faster512 = benchFftSize<512>(20000);
+  const bool faster1024 = benchFftSize<1024>(10000);
+  check(faster512 && faster1024, "RealFft faster than fftInPlace at both sizes");
+}
+
+// ---- dsp: esp-dsp path vs portable path ----
+
+// Host port of esp-dsp's ANSI kernels (dsps_fft2r_init_fc32, dsps_fft2r_fc32_ansi,
+// dsps_bit_rev_fc32): radix-2 DIT over natural-order input with a bit-reversed
+// twiddle table, then a bit-reversal pass. On target the Xtensa assembly version
+// runs the same butterflies.
+namespace espdsp {
+
+static void bitRev(float* z, uint32_t points) {
+  uint32_t j = 0;
+  for (uint32_t i = 1; i + 1 < points; i++) {
+    uint32_t k = points >> 1;
+    while (k <= j) { j -= k; k >>= 1; }
+    j += k;
+    if (i < j) {
+      std::swap(z[2 * i], z[2 * j]);
+      std::swap(z[2 * i + 1], z[2 * j + 1]);
+    }
+  }
+}
+
+static std::vector<float> twiddles(uint32_t points) {
+  std::vector<float> w(points);
+  const float e = (float)(2.0 * FFT_PI / points);
+  for (uint32_t i = 0; i < points / 2; i++) {
+    w[2 * i] = cosf(i * e);
+    w[2 * i + 1] = sinf(i * e);
+  }
+  bitRev(w.data(), points / 2);
+  return w;
+}
+
+static void fft2r(float* z, uint32_t points, const float* w) {
+  uint32_t ie = 1;
+  for (uint32_t n2 = points / 2; n2 > 0; n2 >>= 1, ie <<= 1) {
+    uint32_t ia = 0;
+    for (uint32_t j = 0; j < ie; j++) {
+      const float c = w[2 * j], s = w[2 * j + 1];
+      for (uint32_t i = 0; i < n2; i++, ia++) {
+        const uint32_t m = ia + n2;
+        const float re = c * z[2 * m] + s * z[2 * m + 1];
+        const float im = c * z[2 * m + 1] - s * z[2 * m];
+        z[2 * m] = z[2 * ia] - re;
+        z[2 * m + 1] = z[2 * ia + 1] - im;
+        z[2 * ia] += re;
+        z[2 * ia + 1] += im;
+      }
+      ia += n2;
+    }
+  }
+  bitRev(z, points);
+}
+
+}  // namespace espdsp
+
+template <uint32_t N>
+static double maxRelDiff(const float* a, const float* b) {
+  float peak = 0.0f, err = 0.0f;
+  for (uint32_t i = 0; i < N; i++) {
+    peak = std::max(peak, fabsf(b[i]));
+    err = std::max(err, fabsf(a[i] - b[i]));
+  }
+  return peak > 0.0f ? err / peak : 0.0;
+}
+
+static void benchDsp() {
+  static constexpr uint32_t N = 512;
+  typedef RealFft<N> Fft;
+  static const uint32_t ITERS = 20000;
+  const std::vector<float> w = espdsp::twiddles(N / 2);
+  const std::vector<float> x = jonswapHeave({0.3, 3.0, 3.3}, N, 11);
+  static float esp[N], port[N];
+
+  // Forward: dspRealFft<N> with esp-dsp = complex FFT of the packed samples + split()
+  memcpy(esp, x.data(), sizeof(esp));
+  espdsp::fft2r(esp, N / 2, w.data());
+  Fft::split(esp);
+  memcpy(port, x.data(), sizeof(port));
+  dspRealFft<N>(port);
+  const double fwdErr = maxRelDiff<N>(esp, port);
+
+  // Inverse: merge(), conjugate, esp-dsp FFT, conjugate with 1/(N/2)
+  Fft::merge(esp);
+  Fft::conjugate(esp);
+  espdsp::fft2r(esp, N / 2, w.data());
+  Fft::conjugate(esp, 1.0f / (float)(N / 2));
+  dspRealIfft<N>(port);
+  const double invErr = maxRelDiff<N>(esp, port);
+  const double invVsInput = maxRelDiff<N>(esp, x.data());
+
+  double t0 = nowUs();
+  for (uint32_t it = 0; it < ITERS; it++) {
+    memcpy(esp, x.data(), sizeof(esp));
+    espdsp::fft2r(esp, N / 2, w.data());
+    Fft::split(esp);
+    g_sink = esp[it % N];
+  }
+  double t1 = nowUs();
+  for (uint32_t it = 0; it < ITERS; it++) {
+    memcpy(port, x.data(), sizeof(port));
+    Fft::forward(port);
+    g_sink = port[it % N];
+  }
+  double t2 = nowUs();
+
+  // Vector kernels (portable on the host; esp-dsp's dsps_addc/mul compute the same
+  // single-precision expressions)
+  static float v[N];
+  memcpy(v, x.data(), sizeof(v));
+  double mean = 0.0;
+  for (uint32_t i = 0; i < N; i++) mean += x[i];
+  mean /= N;
+  const float m = dspMean(v, N);
+  dspAddConst(v, N, -m);
+  dspMul(v, Fft::tables.hann, v, N);
+  double winErr = 0.0;
+  for (uint32_t i = 0; i < N; i++) {
+    winErr = std::max(winErr, fabs(v[i] - (x[i] - mean) * Fft::tables.hann[i]));
+  }
+
+  printf("dsp.h backends, %u-point real FFT of a JONSWAP record (%s backend linked)\n", N, dspBackendName());
+  printf("  esp-dsp path vs portable: forward max rel diff %.1e, inverse %.1e (%.1e vs input)\n",
+         fwdErr, invErr, invVsInput);
+  printf("  host time per FFT: esp-dsp ANSI port %.2f us, portable %.2f us (target cycles: WAVE_DSP_SELFTEST=1)\n",
+         (t1 - t0) / ITERS, (t2 - t1) / ITERS);
+  printf("  mean/addc/mul: max abs err %.1e m/s^2\n", winErr);
+  check(fwdErr < 1e-5, "forward FFT backends agree within 1e-5 of the peak bin");
+  check(invErr < 1e-5 && invVsInput < 1e-5, "inverse FFT backends agree and round-trip within 1e-5");
+  check(winErr < 1e-6, "vector kernels within float rounding of double");
+}
+
+// ---- bank: per-sample DFT bank vs FFT per segment ----
+
+struct BankOptions : WaveAnalyzerOptions {
+  static constexpr bool DFT_BANK = true;
+};
+typedef WaveAnalyzer<512, FS, BankOptions> BankAnalyzer;
+
+static void benchBank() {
+  static const Sea SEAS[] = {{0.15, 2.0, 3.3}, {0.30, 3.0, 3.3}, {0.50, 4.5, 3.3}, {0.30, 3.0, 1.0}};
+  static const uint32_t TRIALS = 100;
+  static WelchAnalyzer fft;
+  static BankAnalyzer bank;
+
+  printf("DFT bank (bins %u..%u, per sample) vs FFT per segment, %u records per sea\n",
+         BankAnalyzer::BAND_BIN_MIN, BankAnalyzer::BAND_BIN_MAX, TRIALS);
+  double maxHsDiff = 0.0, maxTpDiff = 0.0, fftUs = 0.0, bankUs = 0.0;
+  uint32_t records = 0;
+  for (const Sea& sea : SEAS) {
+    for (uint32_t t = 0; t < TRIALS; t++) {
+      const std::vector<float> x = jonswapHeave(sea, RECORD, 2000 + t);
+      const double t0 = nowUs();
+      const SpectralWaveStats f = runAnalyzer(fft, x);
+      const double t1 = nowUs();
+      const SpectralWaveStats b = runAnalyzer(bank, x);
+      const double t2 = nowUs();
+      fftUs += t1 - t0;
+      bankUs += t2 - t1;
+      records++;
+      maxHsDiff = std::max(maxHsDiff, fabs(b.Hs / f.Hs - 1.0));
+      maxTpDiff = std::max(maxTpDiff, fabs(b.Tp / f.Tp - 1.0));
+    }
+  }
+  const double samples = (double)records * RECORD;
+  printf("  CPU per sample (push + finish + analyze, host): FFT %.0f ns, DFT bank %.0f ns (%.1fx)\n",
+         1000.0 * fftUs / samples, 1000.0 * bankUs / samples, bankUs / fftUs);
+  printf("  Memory: FFT engine %zu B, DFT bank %zu B\n", sizeof(WelchAnalyzer), sizeof(BankAnalyzer));
+  printf("  Max difference over %u records: Hs %.2e, Tp %.2e (relative)\n", records, maxHsDiff, maxTpDiff);
+  check(maxHsDiff < 1e-3 && maxTpDiff < 1e-3, "DFT bank Hs and Tp within 0.1%% of the FFT engine");
+  check(sizeof(BankAnalyzer) * 3 < sizeof(WelchAnalyzer), "DFT bank under a third of the FFT engine's memory");
+}
+
+// ---- sos: measured Butterworth band-pass response ----
+
+static constexpr double HP_CUTOFF_HZ = 0.03;   // WAVE_HP_CUTOFF_HZ
+static constexpr double LP_CUTOFF_HZ = 2.0;    // WAVE_LP_CUTOFF_HZ
+static constexpr uint32_t HP_SECTIONS = 1;     // 2nd order
+static constexpr uint32_t LP_SECTIONS = 2;     // 4th order
+static constexpr Sos<HP_SECTIONS + LP_SECTIONS> BAND_SOS =
+    sosCascade(butterworthHighpass<HP_SECTIONS>(HP_CUTOFF_HZ, FS),
+               butterworthLowpass<LP_SECTIONS>(LP_CUTOFF_HZ, FS));
+
+static double toDb(double gainSq) { return 10.0 * log10(gainSq); }
+
+// Analog Butterworth magnitude with the bilinear transform's frequency warping
+static double butterworthDb(double f) {
+  const double k = tan(FFT_PI * f / FS);
+  const double hp = pow(tan(FFT_PI * HP_CUTOFF_HZ / FS) / k, 4.0 * HP_SECTIONS);
+  const double lp = pow(k / tan(FFT_PI * LP_CUTOFF_HZ / FS), 4.0 * LP_SECTIONS);
+  return -toDb(1.0 + hp) - toDb(1.0 + lp);
+}
+
+// The former bandLimit(): RC high-pass y = a·(y' + x − x'), then RC low-pass
+// y = α·x + (1 − α)·y', coefficients as computeIIRCoeffs() set them
+static double rcPairDb(double f) {
+  const double dt = 1.0 / FS;
+  const double rcHp = 1.0 / (2.0 * FFT_PI * HP_CUTOFF_HZ), rcLp = 1.0 / (2.0 * FFT_PI * LP_CUTOFF_HZ);
+  const double a = rcHp / (rcHp + dt), alpha = dt / (rcLp + dt);
+  const double th = 2.0 * FFT_PI * f / FS;
+  const double c = cos(th), s = sin(th);   // z⁻¹ = c − j·s
+  const double hpNum = a * a * ((1 - c) * (1 - c) + s * s);
+  const double hpDen = (1 - a * c) * (1 - a * c) + a * a * s * s;
+  const double b = 1 - alpha;
+  const double lpDen = (1 - b * c) * (1 - b * c) + b * b * s * s;
+  return toDb(hpNum / hpDen) + toDb(alpha * alpha / lpDen);
+}
+
+// Gain of SosFilter at f: float sine in, 600 s to settle (the 0.03 Hz section
+// decays with a 7.5 s time constant), then a lock-in over whole periods
+static double measuredDb(double f) {
+  static constexpr uint32_t SETTLE = 6000;
+  SosFilter<HP_SECTIONS + LP_SECTIONS> filt(BAND_SOS);
+  const double w = 2.0 * FFT_PI * f / FS;
+  const uint32_t periods = std::max(4u, (uint32_t)(200.0 * f));
+  const uint32_t n = (uint32_t)lround(periods * FS / f);
+  double re = 0.0, im = 0.0;
+  for (uint32_t i = 0; i < SETTLE + n; i++) {
+    const float y = filt.process((float)sin(w * i));
+    if (i >= SETTLE) {
+      re += y * cos(w * i);
+      im += y * sin(w * i);
+    }
+  }
+  const double amp = 2.0 * hypot(re, im) / n;
+  return toDb(amp * amp);
+}
+
+static void benchSos() {
+  static const double FREQS[] = {0.01, 0.02, 0.03, 0.05, 0.07, 0.1, 0.2, 0.5,
+                                 1.0, 1.5, 2.0, 2.5, 3.0, 4.0, 4.5};
+  printf("Butterworth band-pass as in wave.cpp: 2nd-order HP %.2f Hz + 4th-order LP %.1f Hz, fs %u Hz\n",
+         HP_CUTOFF_HZ, LP_CUTOFF_HZ, FS);
+  printf("  %8s %12s %12s %12s %12s\n", "f (Hz)", "measured dB", "sosGainSq", "closed form", "former RC");
+  double maxMeasErr = 0.0, deepErr = 0.0, maxDesignErr = 0.0;
+  for (double f : FREQS) {
+    const double meas = measuredDb(f);
+    const double design = toDb(sosGainSq(BAND_SOS, f, FS));
+    const double exact = butterworthDb(f);
+    printf("  %8.2f %12.3f %12.3f %12.3f %12.3f\n", f, meas, design, exact, rcPairDb(f));
+    // Float coefficients and state: 0.05 dB is only meaningful above −40 dB
+    if (exact > -40.0) maxMeasErr = std::max(maxMeasErr, fabs(meas - design));
+    else deepErr = std::max(deepErr, fabs(meas - design));
+    maxDesignErr = std::max(maxDesignErr, fabs(design - exact));
+  }
+  printf("  Max |measured - sosGainSq|: %.3f dB above -40 dB, %.3f dB below\n", maxMeasErr, deepErr);
+  check(maxMeasErr < 0.05, "SosFilter gain within 0.05 dB of sosGainSq() above -40 dB");
+  check(deepErr < 0.5, "SosFilter gain within 0.5 dB of sosGainSq() below -40 dB");
+  check(maxDesignErr < 0.01, "float coefficients within 0.01 dB of the prewarped Butterworth");
+  const double hp = measuredDb(HP_CUTOFF_HZ), lp = measuredDb(LP_CUTOFF_HZ);
+  check(fabs(hp + 3.01) < 0.05 && fabs(lp + 3.01) < 0.05, "-3 dB at both cutoffs (%.2f / %.2f dB)", hp, lp);
+  const double at005 = measuredDb(0.05), at1 = measuredDb(1.0);
+  check(fabs(at005 + 0.5) < 0.1 && fabs(at1) < 0.01,
+        "pass band as WAVE.md states: %.2f dB at 0.05 Hz, %.3f dB at 1 Hz", at005, at1);
+  const double at3 = measuredDb(3.0), at4 = measuredDb(4.0);
+  check(fabs(at3 + 22.0) < 1.0 && fabs(at4 + 50.0) < 2.0,
+        "stop band as WAVE.md states: %.1f dB at 3 Hz, %.1f dB at 4 Hz", at3, at4);
+}
+
+// ---- zoom: Tp zoom vs parabola vs zero-padded FFT ----
+
+struct ZoomOptions : WaveAnalyzerOptions {
+  static constexpr uint32_t ZOOM = 8;   // WAVE_TP_ZOOM
+};
+typedef WaveAnalyzer<512, FS, ZoomOptions> ZoomAnalyzer;
+
+static constexpr uint32_t PAD_N = 4096;   // 512 × ZOOM: the same 1/8-bin grid
+
+// Tp from the Welch segments of x (512 points, 50% overlap), each mean-removed,
+// Hann-windowed and zero-padded to PAD_N; displacement PSD peak + parabola
+static float paddedTp(const std::vector<float>& x) {
+  static constexpr uint32_t SEG = 512;
+  typedef RealFft<PAD_N> PadFft;
+  static float buf[PAD_N];
+  static double psd[PAD_N / 2];
+  const double df = (double)FS / PAD_N;
+  const uint32_t kMin = (uint32_t)ceil(WaveAnalyzerOptions::FREQ_MIN / df);
+  const uint32_t kMax = (uint32_t)(WaveAnalyzerOptions::FREQ_MAX / df);
+  memset(psd, 0, sizeof(psd));
+  for (uint32_t off = 0; off + SEG <= x.size(); off += SEG / 2) {
+    double mean = 0.0;
+    for (uint32_t i = 0; i < SEG; i++) mean += x[off + i];
+    mean /= SEG;
+    for (uint32_t i = 0; i < SEG; i++) buf[i] = (float)(x[off + i] - mean) * RealFft<SEG>::tables.hann[i];
+    memset(buf + SEG, 0, (PAD_N - SEG) * sizeof(float));
+    PadFft::forward(buf);
+    for (uint32_t k = kMin; k <= kMax; k++) {
+      const double w = 2.0 * FFT_PI * k * df;
+      psd[k] += ((double)buf[2 * k] * buf[2 * k] + (double)buf[2 * k + 1] * buf[2 * k + 1]) / (w * w * w * w);
+    }
+  }
+  uint32_t peak = kMin;
+  for (uint32_t k = kMin; k <= kMax; k++) if (psd[k] > psd[peak]) peak = k;
+  double f = peak * df;
+  if (peak > kMin && peak < kMax) {
+    const double a = psd[peak - 1], b = psd[peak], c = psd[peak + 1];
+    f = (peak + 0.5 * (a - c) / (a - 2.0 * b + c)) * df;
+  }
+  return (float)(1.0 / f);
+}
+
+// Relative Tp errors of one method
+struct TpError {
+  Spread err;
+  double max = 0.0;
+  void add(double tp, double ref) {
+    const double e = tp / ref - 1.0;
+    err.add(e);
+    max = std::max(max, fabs(e));
+  }
+};
+
+static void benchZoom() {
+  static const uint32_t TONES = 300;
+  static const Sea SEAS[] = {{0.15, 2.0, 3.3}, {0.30, 3.0, 3.3}, {0.50, 4.5, 3.3}, {0.30, 6.0, 3.3}};
+  static const uint32_t TRIALS = 50;
+  static WelchAnalyzer plain;
+  static ZoomAnalyzer zoomed;
+
+  printf("Tp zoom (%u points per bin, +/-2 bins) vs bin parabola vs %u-point zero padding, %u-sample records\n",
+         ZoomOptions::ZOOM, PAD_N, RECORD);
+
+  // Tones 0.125-0.5 Hz, 0.1 m amplitude, random phase, sensor noise
+  TpError tParab, tZoom, tPad;
+  uint32_t zoomUsed = 0;
+  Rng rng(5);
+  for (uint32_t t = 0; t < TONES; t++) {
+    const double f = 0.125 + 0.375 * rng.uniform(), ph = 2.0 * FFT_PI * rng.uniform();
+    const double w = 2.0 * FFT_PI * f;
+    std::vector<float> x(RECORD);
+    for (uint32_t i = 0; i < RECORD; i++) {
+      x[i] = (float)(-w * w * 0.1 * cos(w * i / FS + ph) + SENSOR_NOISE * rng.normal());
+    }
+    tParab.add(runAnalyzer(plain, x).Tp, 1.0 / f);
+    const SpectralWaveStats z = runAnalyzer(zoomed, x);
+    tZoom.add(z.Tp, 1.0 / f);
+    zoomUsed += z.tpZoomed;
+    tPad.add(paddedTp(x), 1.0 / f);
+  }
+  printf("  %-30s %14s %14s %14s\n", "Tp error (RMS / max)", "parabola", "zoom", "zero-padded");
+  printf("  %-30s %6.2f%%/%5.2f%% %6.2f%%/%5.2f%% %6.2f%%/%5.2f%%\n", "300 tones 0.125-0.5 Hz",
+         100 * tParab.err.rms(), 100 * tParab.max, 100 * tZoom.err.rms(), 100 * tZoom.max,
+         100 * tPad.err.rms(), 100 * tPad.max);
+
+  // JONSWAP with every component at its expected amplitude: the spectral peak
+  // is at 1/Tp, so the error is the estimator's, not the sea's variability
+  double plainUs = 0.0, zoomUs = 0.0;
+  uint32_t records = 0, seaZoomUsed = 0;
+  bool seaNoWorse = true;
+  for (const Sea& sea : SEAS) {
+    TpError sParab, sZoom, sPad;
+    for (uint32_t t = 0; t < TRIALS; t++) {
+      const std::vector<float> x = jonswapHeave(sea, RECORD, 3000 + t, false);
+      const double t0 = nowUs();
+      const SpectralWaveStats p = runAnalyzer(plain, x);
+      const double t1 = nowUs();
+      const SpectralWaveStats z = runAnalyzer(zoomed, x);
+      const double t2 = nowUs();
+      plainUs += t1 - t0;
+      zoomUs += t2 - t1;
+      records++;
+      seaZoomUsed += z.tpZoomed;
+      sParab.add(p.Tp, sea.tp);
+      sZoom.add(z.Tp, sea.tp);
+      sPad.add(paddedTp(x), sea.tp);
+    }
+    char label[40];
+    snprintf(label, sizeof(label), "JONSWAP Hs %.2f m, Tp %.1f s", sea.hs, sea.tp);
+    printf("  %-30s %6.2f%%/%5.2f%% %6.2f%%/%5.2f%% %6.2f%%/%5.2f%%\n", label,
+           100 * sParab.err.rms(), 100 * sParab.max, 100 * sZoom.err.rms(), 100 * sZoom.max,
+           100 * sPad.err.rms(), 100 * sPad.max);
+    // Three 512-point segments leave 5-9% Tp scatter from the random phases
+    // alone; zoom must not add to it
+    seaNoWorse = seaNoWorse && sZoom.err.rms() < 1.1 * sParab.err.rms();
+  }
+
+  // Per-segment cost of the padded alternative: window + 4096-point FFT
+  static const uint32_t ITERS = 2000;
+  static float buf[PAD_N];
+  const std::vector<float> x = jonswapHeave({0.3, 3.0, 3.3}, 512, 9);
+  double t0 = nowUs();
+  for (uint32_t it = 0; it < ITERS; it++) {
+    for (uint32_t i = 0; i < 512; i++) buf[i] = x[i] * RealFft<512>::tables.hann[i];
+    memset(buf + 512, 0, (PAD_N - 512) * sizeof(float));
+    RealFft<PAD_N>::forward(buf);
+    g_sink = buf[it % PAD_N];
+  }
+  const double padSegUs = (nowUs() - t0) / ITERS;
+  const double segments = 3.0;   // per 1024-sample record
+  const double zoomExtraUs = (zoomUs - plainUs) / records;
+  printf("  Zoom used on %u/%u tones and %u/%u JONSWAP records (else parabola)\n",
+         zoomUsed, TONES, seaZoomUsed, records);
+  printf("  CPU per record (host): parabola %.0f us, zoom %.0f us (+%.0f us); zero padding instead "
+         "+%.0f us (%u-point FFT per segment)\n",
+         plainUs / records, zoomUs / records, zoomExtraUs, segments * padSegUs, PAD_N);
+  printf("  RAM: zoom +%zu B in the analyzer; zero padding needs a %zu B FFT buffer\n",
+         sizeof(ZoomAnalyzer) - sizeof(WelchAnalyzer), PAD_N * sizeof(float));
+  check(tZoom.err.rms() < 0.2 * tParab.err.rms() && tZoom.err.rms() < 0.2 * tPad.err.rms(),
+        "zoom Tp RMS error on tones under a fifth of the parabola's and of zero padding's");
+  check(tZoom.max < 0.01, "zoom Tp within 1%% on every tone");
+  check(zoomUsed == TONES, "zoom used for every tone");
+  check(seaNoWorse, "zoom Tp RMS error within 10%% of the parabola's on every JONSWAP sea");
+  // Zoom is not cheaper than zero padding (2-3x the CPU on the host); what it
+  // buys is RAM. Record the trade: RAM well below the padded buffer, CPU per record
+  // reported above, checked only against gross regressions.
+  check((sizeof(ZoomAnalyzer) - sizeof(WelchAnalyzer)) * 20 < PAD_N * sizeof(float),
+        "zoom trades CPU for RAM: +%zu B vs a %zu B %u-point FFT buffer",
+        sizeof(ZoomAnalyzer) - sizeof(WelchAnalyzer), PAD_N * sizeof(float), PAD_N);
+  check(zoomExtraUs < 1000.0, "zoom adds under 1 ms per record on the host (%.0f us)", zoomExtraUs);
+}
+
+// ---- burg: AR engine accuracy vs record length ----
+
+typedef ArWaveAnalyzer<RECORD, FS, 24> BurgAnalyzer;   // WAVE_AR_SAMPLES, WAVE_AR_ORDER
+
+static double median(std::vector<double> v) {
+  if (v.empty()) return 0.0;
+  std::sort(v.begin(), v.end());
+  const size_t h = v.size() / 2;
+  return (v.size() % 2) ? v[h] : 0.5 * (v[h - 1] + v[h]);
+}
+
+// |relative error| per record, Hs against the band Hs and Tp against the sea's
+struct ErrorSample {
+  std::vector<double> hs, tp;
+  void add(const SpectralWaveStats& s, double hsRef, double tpRef) {
+    hs.push_back(fabs(s.Hs / hsRef - 1.0));
+    tp.push_back(fabs(s.Tp / tpRef - 1.0));
+  }
+};
+
+static void benchBurg() {
+  static const uint32_t LENGTHS[] = {300, 450, 600, 800, RECORD};   // 30-102.4 s
+  static const Sea SEAS[] = {{0.15, 2.0, 3.3}, {0.30, 3.0, 3.3}, {0.50, 4.5, 3.3}, {0.30, 3.0, 1.0}};
+  static const uint32_t TRIALS = 100;
+  static BurgAnalyzer burg;
+  static WelchAnalyzer welch;
+
+  printf("Burg AR(24) vs streaming Welch by record length, %u random JONSWAP records per sea, %zu seas\n",
+         TRIALS, sizeof(SEAS) / sizeof(SEAS[0]));
+  printf("  %-14s %-8s %12s %12s\n", "record", "engine", "Hs med |err|", "Tp med |err|");
+  double burgHs[5], burgTp[5], welchHs[5], welchTp[5];
+  for (uint32_t d = 0; d < 5; d++) {
+    const uint32_t n = LENGTHS[d];
+    ErrorSample b, w;
+    for (const Sea& sea : SEAS) {
+      const double hsRef = bandHs(sea, WaveAnalyzerOptions::FREQ_MIN, WaveAnalyzerOptions::FREQ_MAX);
+      for (uint32_t t = 0; t < TRIALS; t++) {
+        const std::vector<float> x = jonswapHeave(sea, n, 4000 + t);
+        b.add(runAnalyzer(burg, x), hsRef, sea.tp);
+        if (n >= 512) w.add(runAnalyzer(welch, x), hsRef, sea.tp);
+      }
+    }
+    char label[24];
+    snprintf(label, sizeof(label), "%.0fs (%u)", (double)n / FS, n);
+    burgHs[d] = median(b.hs);
+    burgTp[d] = median(b.tp);
+    printf("  %-14s %-8s %11.1f%% %11.1f%%\n", label, "Burg", 100 * burgHs[d], 100 * burgTp[d]);
+    welchHs[d] = welchTp[d] = NAN;
+    if (!w.hs.empty()) {
+      welchHs[d] = median(w.hs);
+      welchTp[d] = median(w.tp);
+      printf("  %-14s %-8s %11.1f%% %11.1f%%\n", "", "Welch", 100 * welchHs[d], 100 * welchTp[d]);
+    } else {
+      printf("  %-14s %-8s %12s %12s\n", "", "Welch", "-", "-");
+    }
+  }
+  printf("  Memory: Burg %zu B, Welch %zu B\n", sizeof(BurgAnalyzer), sizeof(WelchAnalyzer));
+  check(burgHs[4] < burgHs[0] && burgTp[4] < burgTp[0], "Burg error falls from 30 s to 102 s records");
+  check(burgHs[2] < 0.10 && burgTp[2] < 0.05, "Burg at 60 s: Hs within 10%%, Tp within 5%% (median)");
+  check(burgTp[2] < welchTp[2], "Burg Tp beats Welch on a 60 s record (one segment)");
+  check(burgHs[2] < 1.5 * welchHs[4] && burgTp[2] < welchTp[4],
+        "Burg at 60 s: Hs within 1.5x and Tp better than Welch at 102 s");
+}
+
+// ---- Driver ----
+
+struct Section {
+  const char* name;
+  void (*run)();
+};
+
+static const Section SECTIONS[] = {
+  {"welch", benchWelch},
+  {"fft", benchFft},
+  {"dsp", benchDsp},
+  {"bank", benchBank},
+  {"sos", benchSos},
+  {"zoom", benchZoom},
+  {"burg", benchBurg},
+};
+
+int main(int argc, char** argv) {
+  bool any = false;
+  for (const Section& s : SECTIONS) {
+    bool selected = (argc < 2);
+    for (int i = 1; i < argc; i++) selected = selected || strcmp(argv[i], s.name) == 0;
+    if (!selected) continue;
+    any = true;
+    printf("== %s ==\n", s.name);
+    s.run();
+    printf("\n");
+  }
+  if (!any) {
+    fprintf(stderr, "wave_bench: unknown section; one of:");
+    for (const Section& s : SECTIONS) fprintf(stderr, " %s", s.name);
+    fprintf(stderr, "\n");
+    return 2;
+  }
+  printf("%s\n", g_failed ? "FAILED" : "All checks passed");
+  return g_failed ? 1 : 0;
+}
@@ -0,0 +1,184 @@
+//
+// Host replay of a raw IMU capture (WAVE_RAW_CAPTURE) through the wave pipeline.
+//
+// Reads the CSV block that logWaveStats() prints (the "# PlayBuoy raw IMU capture"
+// header, "idx,ax,ay,az[,gx,gy,gz]" rows, "# end raw IMU capture"; any other lines,
+// e.g. the rest of a serial log, are skipped) and runs the counts through the same
+// steps as processSample() in src/wave.cpp with its default build flags:
+// 1g sanity gate, 0.02 Hz gravity tracker, heave projection and ±5 m/s² clamp,
+// Butterworth band-pass 0.03-2 Hz (biquad.h), 576 settling samples. The settled
+// heave then goes into each engine (wave_analyzer.h, ar_analyzer.h) and the tool
+// prints Hs, Tp and the analysed samples for each, without the sanity caps.
+//
+// Gyro columns are ignored (the replay always uses the accel-only gravity tracker,
+// so pass --settle 576 or more for WAVE_GYRO_ATTITUDE captures; the default is 576).
+// Constants mirror src/wave.cpp; keep them in sync.
+//
+// Build (from the repo root):
+//   g++ -std=c++17 -O2 -Isrc tools/wave_replay/wave_replay.cpp src/dsp.cpp -o wave_replay
+// Usage:
+//   ./wave_replay [--settle N] [capture.log]   (or the log on stdin)
+//
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "biquad.h"
+#include "wave_analyzer.h"
+#include "ar_analyzer.h"
+
+static constexpr uint32_t FS = 10;
+static constexpr float FS_HZ = (float)FS;
+static constexpr float ACCEL_SCALE = 9.80665f / 16384.0f;   // ±2g registers
+static constexpr float G_TRACK_FC_HZ = 0.02f;
+static constexpr double HP_CUTOFF_HZ = 0.03;
+static constexpr double LP_CUTOFF_HZ = 2.0;
+static constexpr uint32_t SETTLE_SAMPLES = 576;
+static constexpr uint32_t FFT_N = 512;
+
+static constexpr Sos<3> BAND_SOS =
+    sosCascade(butterworthHighpass<1>(HP_CUTOFF_HZ, FS), butterworthLowpass<2>(LP_CUTOFF_HZ, FS));
+
+struct FftOptions : WaveAnalyzerOptions {
+  static constexpr uint32_t ZOOM = 0;   // WAVE_TP_ZOOM (8 to replay a swell-site build)
+};
+struct BankOptions : WaveAnalyzerOptions {
+  static constexpr bool DFT_BANK = true;
+};
+
+static WaveAnalyzer<FFT_N, FS, FftOptions> s_fft;
+static WaveAnalyzer<FFT_N, FS, BankOptions> s_bank;
+static ArWaveAnalyzer<2 * FFT_N, FS, 24, FftOptions> s_burg;   // WAVE_AR_ORDER, WAVE_AR_SAMPLES
+
+struct Frame {
+  int16_t x, y, z;
+};
+
+// Capture rows from the log; returns false if no capture block was found
+static bool readCapture(FILE* in, std::vector<Frame>& frames) {
+  char line[256];
+  bool inBlock = false, found = false;
+  while (fgets(line, sizeof(line), in)) {
+    if (strncmp(line, "# PlayBuoy raw IMU capture", 26) == 0) {
+      const char* fs = strstr(line, "fs=");
+      if (fs && atoi(fs + 3) != (int)FS) {
+        fprintf(stderr, "wave_replay: capture is at %d Hz, the pipeline expects %u Hz\n",
+                atoi(fs + 3), FS);
+        return false;
+      }
+      frames.clear();   // Keep the last capture in the log
+      inBlock = true;
+      found = true;
+      continue;
+    }
+    if (!inBlock) continue;
+    if (strncmp(line, "# end raw IMU capture", 21) == 0) {
+      inBlock = false;
+      continue;
+    }
+    long idx;
+    int ax, ay, az;
+    if (sscanf(line, "%ld,%d,%d,%d", &idx, &ax, &ay, &az) == 4) {
+      frames.push_back({(int16_t)ax, (int16_t)ay, (int16_t)az});
+    }
+  }
+  return found;
+}
+
+int main(int argc, char** argv) {
+  uint32_t settle = SETTLE_SAMPLES;
+  const char* path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--settle") == 0 && i + 1 < argc) settle = (uint32_t)atoi(argv[++i]);
+    else path = argv[i];
+  }
+  FILE* in = path ? fopen(path, "r") : stdin;
+  if (!in) {
+    fprintf(stderr, "wave_replay: cannot open %s\n", path);
+    return 1;
+  }
+  std::vector<Frame> frames;
+  const bool found = readCapture(in, frames);
+  if (path) fclose(in);
+  if (!found || frames.empty()) {
+    fprintf(stderr, "wave_replay: no raw IMU capture in the input\n");
+    return 1;
+  }
+
+  // processSample(), accel-only tracker, band-pass pre-filter
+  SosFilter<3> band(BAND_SOS);
+  s_fft.reset();
+  s_bank.reset();
+  s_burg.reset();
+  float gx = 0.0f, gy = 0.0f, gz = 9.80665f;
+  const float dt = 1.0f / FS_HZ;
+  const float rc = 1.0f / (2.0f * (float)FFT_PI * G_TRACK_FC_HZ);
+  const float alpha = dt / (rc + dt);
+  uint32_t sampleCount = 0, rejected = 0;
+  double heaveSq = 0.0, heaveAbs = 0.0;
+  for (const Frame& f : frames) {
+    const float ax = f.x * ACCEL_SCALE, ay = f.y * ACCEL_SCALE, az = f.z * ACCEL_SCALE;
+    const float amag = sqrtf(ax * ax + ay * ay + az * az);
+    if (fabsf(amag - 9.80665f) > 4.9f) {
+      rejected++;
+      continue;
+    }
+    gx = (1.0f - alpha) * gx + alpha * ax;
+    gy = (1.0f - alpha) * gy + alpha * ay;
+    gz = (1.0f - alpha) * gz + alpha * az;
+    float gnorm = sqrtf(gx * gx + gy * gy + gz * gz);
+    if (gnorm < 1e-3f) gnorm = 9.80665f;
+    float heave = -((ax - gx) * gx + (ay - gy) * gy + (az - gz) * gz) / gnorm;
+    if (fabsf(heave) < 0.001f) heave = 0.0f;
+    heave = std::min(5.0f, std::max(-5.0f, heave));
+    const float a = band.process(heave);
+    if (sampleCount >= settle) {
+      s_fft.push(a);
+      s_bank.push(a);
+      s_burg.push(a);
+    }
+    sampleCount++;
+    heaveSq += (double)a * a;
+    heaveAbs += fabsf(a);
+  }
+
+  const float rms = sampleCount ? sqrtf((float)(heaveSq / sampleCount)) : 0.0f;
+  const float meanAbs = sampleCount ? (float)(heaveAbs / sampleCount) : 0.0f;
+  printf("Capture: %zu frames, %u rejected (|a| far from 1g), %u settling\n",
+         frames.size(), rejected, std::min(settle, sampleCount));
+  printf("Heave: rms %.4f m/s^2, mean |a| %.4f m/s^2%s\n", rms, meanAbs,
+         (rms < 0.01f && meanAbs < 0.005f) ? " (below the calm gate: the buoy reports Hs 0)" : "");
+
+  printf("%-18s %8s %8s %9s %s\n", "engine", "Hs (m)", "Tp (s)", "samples", "notes");
+  if (s_fft.segments() > 0) {
+    s_fft.finish();
+    const SpectralWaveStats ws = s_fft.analyze();
+    const float ci = s_fft.hsConfidence(NULL);
+    char note[64];
+    snprintf(note, sizeof(note), "%u segments, Tp %s", s_fft.segments(), ws.tpZoomed ? "zoom" : "parabola");
+    printf("%-18s %8.3f %8.2f %9u %s", "Welch FFT", ws.Hs, ws.Tp, s_fft.samples(), note);
+    if (!isnan(ci)) printf(", Hs CI ±%.3f m", ci);
+    printf(", out-of-band %.1f dB\n", s_fft.bandLevelDb(2.0f, 4.5f));
+  } else {
+    printf("%-18s %8s %8s %9u no complete %u-sample segment\n", "Welch FFT", "-", "-", s_fft.samples(), FFT_N);
+  }
+  if (s_bank.segments() > 0) {
+    s_bank.finish();
+    const SpectralWaveStats ws = s_bank.analyze();
+    printf("%-18s %8.3f %8.2f %9u %u segments\n", "DFT bank", ws.Hs, ws.Tp, s_bank.samples(), s_bank.segments());
+  } else {
+    printf("%-18s %8s %8s %9u no complete segment\n", "DFT bank", "-", "-", s_bank.samples());
+  }
+  s_burg.finish();
+  if (s_burg.segments() > 0) {
+    const SpectralWaveStats ws = s_burg.analyze();
+    printf("%-18s %8.3f %8.2f %9u AR(24) of the first %u settled samples\n", "Burg AR", ws.Hs, ws.Tp,
+           s_burg.samples(), 2 * FFT_N);
+  } else {
+    printf("%-18s %8s %8s %9u record too short\n", "Burg AR", "-", "-", s_burg.samples());
+  }
+  return 0;
+}